@@ -0,0 +1,192 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "asyncevaluator.h"
+
+#include <glog/logging.h>
+
+#include <utility>
+
+#include "../common.h"
+
+using namespace std;
+
+namespace hit {
+
+    AsyncEvaluator::AsyncEvaluator(CKKSEvaluator &eval, int max_concurrency)
+        : eval(eval), scheduler_(max_concurrency) {
+    }
+
+    AsyncEvaluator::~AsyncEvaluator() {
+        wait();
+    }
+
+    void AsyncEvaluator::wait() {
+        scheduler_.wait();
+    }
+
+    AsyncCiphertext AsyncEvaluator::ready(const CKKSCiphertext &ct) {
+        return make_ready_future(ct);
+    }
+
+    AsyncCiphertext AsyncEvaluator::submit(vector<AsyncCiphertext> inputs, Operation op) {
+        return scheduler_.submit_all<CKKSCiphertext>(move(op), move(inputs));
+    }
+
+    AsyncCiphertext AsyncEvaluator::encrypt(const vector<double> &coeffs) {
+        return submit({}, [this, coeffs](const vector<const CKKSCiphertext *> &) { return eval.encrypt(coeffs); });
+    }
+
+    AsyncCiphertext AsyncEvaluator::encrypt(const vector<double> &coeffs, int level) {
+        return submit({}, [this, coeffs, level](const vector<const CKKSCiphertext *> &) {
+            return eval.encrypt(coeffs, level);
+        });
+    }
+
+    AsyncCiphertext AsyncEvaluator::rotate_right(const AsyncCiphertext &ct, int steps) {
+        return submit({ct}, [this, steps](const vector<const CKKSCiphertext *> &cts) {
+            return eval.rotate_right(*cts[0], steps);
+        });
+    }
+
+    AsyncCiphertext AsyncEvaluator::rotate_left(const AsyncCiphertext &ct, int steps) {
+        return submit({ct}, [this, steps](const vector<const CKKSCiphertext *> &cts) {
+            return eval.rotate_left(*cts[0], steps);
+        });
+    }
+
+    AsyncCiphertext AsyncEvaluator::add_plain(const AsyncCiphertext &ct, double scalar) {
+        return submit({ct}, [this, scalar](const vector<const CKKSCiphertext *> &cts) {
+            return eval.add_plain(*cts[0], scalar);
+        });
+    }
+
+    AsyncCiphertext AsyncEvaluator::add_plain(const AsyncCiphertext &ct, const vector<double> &plain) {
+        return submit({ct}, [this, plain](const vector<const CKKSCiphertext *> &cts) {
+            return eval.add_plain(*cts[0], plain);
+        });
+    }
+
+    AsyncCiphertext AsyncEvaluator::add(const AsyncCiphertext &ct1, const AsyncCiphertext &ct2) {
+        return submit({ct1, ct2},
+                      [this](const vector<const CKKSCiphertext *> &cts) { return eval.add(*cts[0], *cts[1]); });
+    }
+
+    AsyncCiphertext AsyncEvaluator::add_many(const vector<AsyncCiphertext> &cts) {
+        return submit(cts, [this](const vector<const CKKSCiphertext *> &inputs) {
+            vector<CKKSCiphertext> values;
+            values.reserve(inputs.size());
+            for (const auto *input : inputs) {
+                values.push_back(*input);
+            }
+            return eval.add_many(values);
+        });
+    }
+
+    AsyncCiphertext AsyncEvaluator::negate(const AsyncCiphertext &ct) {
+        return submit({ct}, [this](const vector<const CKKSCiphertext *> &cts) { return eval.negate(*cts[0]); });
+    }
+
+    AsyncCiphertext AsyncEvaluator::sub_plain(const AsyncCiphertext &ct, double scalar) {
+        return submit({ct}, [this, scalar](const vector<const CKKSCiphertext *> &cts) {
+            return eval.sub_plain(*cts[0], scalar);
+        });
+    }
+
+    AsyncCiphertext AsyncEvaluator::sub_plain(const AsyncCiphertext &ct, const vector<double> &plain) {
+        return submit({ct}, [this, plain](const vector<const CKKSCiphertext *> &cts) {
+            return eval.sub_plain(*cts[0], plain);
+        });
+    }
+
+    AsyncCiphertext AsyncEvaluator::sub(const AsyncCiphertext &ct1, const AsyncCiphertext &ct2) {
+        return submit({ct1, ct2},
+                      [this](const vector<const CKKSCiphertext *> &cts) { return eval.sub(*cts[0], *cts[1]); });
+    }
+
+    AsyncCiphertext AsyncEvaluator::multiply_plain(const AsyncCiphertext &ct, double scalar) {
+        return submit({ct}, [this, scalar](const vector<const CKKSCiphertext *> &cts) {
+            return eval.multiply_plain(*cts[0], scalar);
+        });
+    }
+
+    AsyncCiphertext AsyncEvaluator::multiply_plain(const AsyncCiphertext &ct, const vector<double> &plain) {
+        return submit({ct}, [this, plain](const vector<const CKKSCiphertext *> &cts) {
+            return eval.multiply_plain(*cts[0], plain);
+        });
+    }
+
+    AsyncCiphertext AsyncEvaluator::multiply(const AsyncCiphertext &ct1, const AsyncCiphertext &ct2) {
+        return submit({ct1, ct2},
+                      [this](const vector<const CKKSCiphertext *> &cts) { return eval.multiply(*cts[0], *cts[1]); });
+    }
+
+    AsyncCiphertext AsyncEvaluator::multiply_relin_rescale(const AsyncCiphertext &ct1, const AsyncCiphertext &ct2) {
+        return submit({ct1, ct2}, [this](const vector<const CKKSCiphertext *> &cts) {
+            return eval.multiply_relin_rescale(*cts[0], *cts[1]);
+        });
+    }
+
+    AsyncCiphertext AsyncEvaluator::multiply_plain_rescale(const AsyncCiphertext &ct, double scalar) {
+        return submit({ct}, [this, scalar](const vector<const CKKSCiphertext *> &cts) {
+            return eval.multiply_plain_rescale(*cts[0], scalar);
+        });
+    }
+
+    AsyncCiphertext AsyncEvaluator::multiply_plain_rescale(const AsyncCiphertext &ct, const vector<double> &plain) {
+        return submit({ct}, [this, plain](const vector<const CKKSCiphertext *> &cts) {
+            return eval.multiply_plain_rescale(*cts[0], plain);
+        });
+    }
+
+    AsyncCiphertext AsyncEvaluator::inner_product(const vector<AsyncCiphertext> &cts1,
+                                                  const vector<AsyncCiphertext> &cts2) {
+        if (cts1.size() != cts2.size()) {
+            LOG_AND_THROW_STREAM("Inputs to inner_product must have the same size: " << cts1.size()
+                                                                                      << "!=" << cts2.size());
+        }
+        vector<AsyncCiphertext> inputs(cts1);
+        inputs.insert(inputs.end(), cts2.begin(), cts2.end());
+        size_t size = cts1.size();
+        return submit(move(inputs), [this, size](const vector<const CKKSCiphertext *> &cts) {
+            vector<CKKSCiphertext> values1;
+            vector<CKKSCiphertext> values2;
+            values1.reserve(size);
+            values2.reserve(size);
+            for (size_t i = 0; i < size; i++) {
+                values1.push_back(*cts[i]);
+                values2.push_back(*cts[size + i]);
+            }
+            return eval.inner_product(values1, values2);
+        });
+    }
+
+    AsyncCiphertext AsyncEvaluator::square(const AsyncCiphertext &ct) {
+        return submit({ct}, [this](const vector<const CKKSCiphertext *> &cts) { return eval.square(*cts[0]); });
+    }
+
+    AsyncCiphertext AsyncEvaluator::reduce_level_to(const AsyncCiphertext &ct, const AsyncCiphertext &target) {
+        return submit({ct, target}, [this](const vector<const CKKSCiphertext *> &cts) {
+            return eval.reduce_level_to(*cts[0], *cts[1]);
+        });
+    }
+
+    AsyncCiphertext AsyncEvaluator::reduce_level_to(const AsyncCiphertext &ct, int level) {
+        return submit({ct}, [this, level](const vector<const CKKSCiphertext *> &cts) {
+            return eval.reduce_level_to(*cts[0], level);
+        });
+    }
+
+    AsyncCiphertext AsyncEvaluator::rescale_to_next(const AsyncCiphertext &ct) {
+        return submit({ct},
+                      [this](const vector<const CKKSCiphertext *> &cts) { return eval.rescale_to_next(*cts[0]); });
+    }
+
+    AsyncCiphertext AsyncEvaluator::relinearize(const AsyncCiphertext &ct) {
+        return submit({ct}, [this](const vector<const CKKSCiphertext *> &cts) {
+            CKKSCiphertext result = *cts[0];
+            eval.relinearize_inplace(result);
+            return result;
+        });
+    }
+}  // namespace hit
@@ -0,0 +1,116 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "../scheduler.h"
+#include "ciphertext.h"
+#include "evaluator.h"
+
+namespace hit {
+
+    // The result of an asynchronous homomorphic operation
+    using AsyncCiphertext = Future<CKKSCiphertext>;
+
+    /* An asynchronous interface to a `CKKSEvaluator`. Each operation takes its inputs as futures and returns
+     * a future for its output immediately. The operation runs in this instance's task arena as soon as all of
+     * its inputs are ready, so independent branches of a circuit (e.g., multiple heads, or residual paths)
+     * run concurrently without any explicit parallel loops:
+     *
+     *     AsyncEvaluator async_eval(ckks_instance);
+     *     AsyncCiphertext x = async_eval.encrypt(coeffs);
+     *     AsyncCiphertext y = async_eval.add(async_eval.square(x), async_eval.rotate_left(x, 1));
+     *     CKKSCiphertext result = y.get();
+     *
+     * If an operation throws an exception (e.g., because its inputs are at different levels), its future
+     * holds the exception, and so does the future of every operation which depends on it.
+     *
+     * Inputs may be futures returned by any AsyncEvaluator, or futures which are already ready. Evaluators
+     * which parallelize operations internally (e.g., HomomorphicEval) run their parallel loops in the same
+     * arena. See `CKKSEvaluator` for the semantics of each operation.
+     * All member functions are thread-safe.
+     */
+    class AsyncEvaluator {
+       public:
+        /* Operations run in an arena which runs at most `max_concurrency` tasks at once. If `max_concurrency`
+         * is 0, the limit is the number of hardware threads.
+         */
+        explicit AsyncEvaluator(CKKSEvaluator &eval, int max_concurrency = 0);
+
+        // Waits for all scheduled operations to finish.
+        ~AsyncEvaluator();
+
+        AsyncEvaluator(const AsyncEvaluator &) = delete;
+        AsyncEvaluator &operator=(const AsyncEvaluator &) = delete;
+        AsyncEvaluator(AsyncEvaluator &&) = delete;
+        AsyncEvaluator &operator=(AsyncEvaluator &&) = delete;
+
+        // Block until every scheduled operation has finished.
+        void wait();
+
+        // Returns a future which is already ready, holding `ct`.
+        static AsyncCiphertext ready(const CKKSCiphertext &ct);
+
+        AsyncCiphertext encrypt(const std::vector<double> &coeffs);
+
+        AsyncCiphertext encrypt(const std::vector<double> &coeffs, int level);
+
+        AsyncCiphertext rotate_right(const AsyncCiphertext &ct, int steps);
+
+        AsyncCiphertext rotate_left(const AsyncCiphertext &ct, int steps);
+
+        AsyncCiphertext add_plain(const AsyncCiphertext &ct, double scalar);
+
+        AsyncCiphertext add_plain(const AsyncCiphertext &ct, const std::vector<double> &plain);
+
+        AsyncCiphertext add(const AsyncCiphertext &ct1, const AsyncCiphertext &ct2);
+
+        AsyncCiphertext add_many(const std::vector<AsyncCiphertext> &cts);
+
+        AsyncCiphertext negate(const AsyncCiphertext &ct);
+
+        AsyncCiphertext sub_plain(const AsyncCiphertext &ct, double scalar);
+
+        AsyncCiphertext sub_plain(const AsyncCiphertext &ct, const std::vector<double> &plain);
+
+        AsyncCiphertext sub(const AsyncCiphertext &ct1, const AsyncCiphertext &ct2);
+
+        AsyncCiphertext multiply_plain(const AsyncCiphertext &ct, double scalar);
+
+        AsyncCiphertext multiply_plain(const AsyncCiphertext &ct, const std::vector<double> &plain);
+
+        AsyncCiphertext multiply(const AsyncCiphertext &ct1, const AsyncCiphertext &ct2);
+
+        AsyncCiphertext multiply_relin_rescale(const AsyncCiphertext &ct1, const AsyncCiphertext &ct2);
+
+        AsyncCiphertext multiply_plain_rescale(const AsyncCiphertext &ct, double scalar);
+
+        AsyncCiphertext multiply_plain_rescale(const AsyncCiphertext &ct, const std::vector<double> &plain);
+
+        AsyncCiphertext inner_product(const std::vector<AsyncCiphertext> &cts1,
+                                      const std::vector<AsyncCiphertext> &cts2);
+
+        AsyncCiphertext square(const AsyncCiphertext &ct);
+
+        AsyncCiphertext reduce_level_to(const AsyncCiphertext &ct, const AsyncCiphertext &target);
+
+        AsyncCiphertext reduce_level_to(const AsyncCiphertext &ct, int level);
+
+        AsyncCiphertext rescale_to_next(const AsyncCiphertext &ct);
+
+        AsyncCiphertext relinearize(const AsyncCiphertext &ct);
+
+        CKKSEvaluator &eval;
+
+       private:
+        using Operation = std::function<CKKSCiphertext(const std::vector<const CKKSCiphertext *> &)>;
+
+        // Schedule `op` to run on the values of `inputs` once they are all ready.
+        AsyncCiphertext submit(std::vector<AsyncCiphertext> inputs, Operation op);
+
+        TaskScheduler scheduler_;
+    };
+}  // namespace hit
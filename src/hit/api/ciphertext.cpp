@@ -61,7 +61,9 @@ namespace hit {
         proto_ct->set_he_level(he_level_);
 
         // if the backend_ct is initialized, serialize it
-        if (backend_ct.parms_id() != parms_id_zero) {
+        if (seeded_ct_ != nullptr) {
+            proto_ct->set_ct(*seeded_ct_);
+        } else if (backend_ct.parms_id() != parms_id_zero) {
             ostringstream ct_stream;
             backend_ct.save(ct_stream);
             proto_ct->set_ct(ct_stream.str());
@@ -3,6 +3,10 @@
 
 #pragma once
 
+#include <cstdint>
+#include <memory>
+#include <string>
+
 #include "hit/api/context.h"
 #include "hit/protobuf/ciphertext.pb.h"
 #include "hit/protobuf/ciphertext_vector.pb.h"
@@ -23,6 +27,8 @@ namespace hit {
         CKKSCiphertext(const std::shared_ptr<HEContext> &context, std::istream &stream);
 
         // Serialize a ciphertext to a protobuf object
+        // A fresh ciphertext produced by secret-key encryption is serialized in SEAL's seeded form,
+        // which is roughly half the size of a full ciphertext.
         // This function is typically used in protobuf serialization code for objects which
         // contain a protobuf::Ciphertext. When used directly, you are responsible for
         // calling `delete` on the pointer. When passed as an argument to a protocol buffer
@@ -56,6 +62,7 @@ namespace hit {
         friend class OpCount;
         friend class ScaleEstimator;
         friend class RotationSet;
+        friend class CircuitRecorder;
         friend class CKKSEvaluator;
 
        private:
@@ -70,6 +77,10 @@ namespace hit {
 
         seal::Ciphertext backend_ct;
 
+        // The seeded serialization of `backend_ct`, if this ciphertext was produced by secret-key encryption
+        // and has not been modified since. Evaluators must reset this whenever they modify `backend_ct`.
+        std::shared_ptr<const std::string> seeded_ct_;
+
         // `scale` is used by the ScaleEstimator evaluator
         double scale_ = pow(2, 30);
 
@@ -85,6 +96,9 @@ namespace hit {
 
         bool needs_relin_ = false;
         bool needs_rescale_ = false;
+
+        // The value this ciphertext holds in a circuit recorded by the CircuitRecorder evaluator, or -1
+        int64_t circuit_value_ = -1;
     };
 
     inline protobuf::CiphertextVector *serialize_vector(const std::vector<CKKSCiphertext> &ciphertext_vector) {
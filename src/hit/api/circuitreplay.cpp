@@ -0,0 +1,408 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "circuitreplay.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <utility>
+
+#include "../common.h"
+
+using namespace std;
+
+namespace hit {
+
+    namespace {
+        // Throw an exception unless `op` has the number of inputs, outputs, and parameters its type requires
+        void check_op(const protobuf::CircuitOp &op, uint64_t num_plaintexts) {
+            int expected_inputs = 1;
+            int expected_outputs = 1;
+            bool valid_params = true;
+            switch (op.type()) {
+                case protobuf::CircuitOp::ENCRYPT:
+                    expected_inputs = 0;
+                    valid_params = op.has_level();
+                    break;
+                case protobuf::CircuitOp::ROTATE_LEFT:
+                case protobuf::CircuitOp::ROTATE_RIGHT:
+                    valid_params = op.steps_size() == 1;
+                    break;
+                case protobuf::CircuitOp::ROTATE_MANY:
+                    expected_outputs = op.steps_size();
+                    break;
+                case protobuf::CircuitOp::ADD:
+                case protobuf::CircuitOp::SUB:
+                case protobuf::CircuitOp::MULTIPLY:
+                case protobuf::CircuitOp::MULTIPLY_RELIN_RESCALE:
+                    expected_inputs = 2;
+                    break;
+                case protobuf::CircuitOp::ADD_PLAIN_SCALAR:
+                case protobuf::CircuitOp::SUB_PLAIN_SCALAR:
+                case protobuf::CircuitOp::MULTIPLY_PLAIN_SCALAR:
+                case protobuf::CircuitOp::MULTIPLY_PLAIN_RESCALE_SCALAR:
+                    valid_params = op.has_scalar();
+                    break;
+                case protobuf::CircuitOp::ADD_PLAIN:
+                case protobuf::CircuitOp::SUB_PLAIN:
+                case protobuf::CircuitOp::MULTIPLY_PLAIN:
+                case protobuf::CircuitOp::MULTIPLY_PLAIN_RESCALE:
+                    valid_params = op.has_plaintext() && op.plaintext() < num_plaintexts;
+                    break;
+                case protobuf::CircuitOp::INNER_PRODUCT:
+                    // the inputs are two non-empty vectors of the same length
+                    expected_inputs = (op.inputs_size() > 0 && op.inputs_size() % 2 == 0) ? op.inputs_size() : 2;
+                    break;
+                case protobuf::CircuitOp::REDUCE_LEVEL_TO:
+                    valid_params = op.has_level();
+                    break;
+                case protobuf::CircuitOp::NEGATE:
+                case protobuf::CircuitOp::SQUARE:
+                case protobuf::CircuitOp::RESCALE_TO_NEXT:
+                case protobuf::CircuitOp::RELINEARIZE:
+                    break;
+                default:
+                    LOG_AND_THROW_STREAM("Unknown circuit operation type: " << op.type());
+            }
+            if (op.inputs_size() != expected_inputs || op.outputs_size() != expected_outputs) {
+                LOG_AND_THROW_STREAM("Circuit operation of type " << protobuf::CircuitOp::Type_Name(op.type())
+                                                                  << " has " << op.inputs_size() << " inputs and "
+                                                                  << op.outputs_size() << " outputs");
+            }
+            if (!valid_params) {
+                LOG_AND_THROW_STREAM("Circuit operation of type " << protobuf::CircuitOp::Type_Name(op.type())
+                                                                  << " has invalid parameters");
+            }
+        }
+    }  // namespace
+
+    struct CircuitReplay::RunState {
+        RunState(CKKSEvaluator &evaluator, size_t num_values, size_t num_ops)
+            : eval(evaluator), values(num_values), uses(num_values), pending_inputs(num_ops) {
+        }
+
+        CKKSEvaluator &eval;
+        vector<CKKSCiphertext> values;
+        // the number of remaining uses of each value; a value is released when this reaches zero
+        vector<atomic<int>> uses;
+        // the number of inputs of each operation which have not been computed
+        vector<atomic<int>> pending_inputs;
+        // the number of live operations which have not completed
+        atomic<size_t> remaining_ops{0};
+        // set when `remaining_ops` reaches zero
+        promise<void> done;
+
+        // once an operation fails, operations which have not started are skipped
+        atomic<bool> failed{false};
+        mutex error_mutex;
+        exception_ptr error;
+    };
+
+    CircuitReplay::CircuitReplay(const protobuf::Circuit &circuit, int max_concurrency) : scheduler_(max_concurrency) {
+        load(circuit);
+    }
+
+    CircuitReplay::CircuitReplay(istream &stream, int max_concurrency) : scheduler_(max_concurrency) {
+        protobuf::Circuit proto_circuit;
+        if (!proto_circuit.ParseFromIstream(&stream)) {
+            LOG_AND_THROW_STREAM("Failed to parse a circuit");
+        }
+        load(proto_circuit);
+    }
+
+    void CircuitReplay::load(const protobuf::Circuit &circuit) {
+        if (circuit.num_slots() <= 0) {
+            LOG_AND_THROW_STREAM("Circuit must have a positive number of slots; got " << circuit.num_slots());
+        }
+        // Plaintexts are unpacked once here, and are not duplicated in `circuit_`.
+        circuit_ = circuit;
+        for (const auto &proto_plain : circuit_.plaintexts()) {
+            plaintexts_.emplace_back(proto_plain.coeffs().begin(), proto_plain.coeffs().end());
+        }
+        circuit_.clear_plaintexts();
+
+        // Values must be produced in order, and only read after they are produced, so the recorded order of
+        // the operations is a topological order of the graph.
+        uint64_t num_values = circuit_.num_values();
+        // the operation which produces each value
+        vector<uint64_t> producers;
+        uint64_t next_value = 0;
+        for (int i = 0; i < circuit_.ops_size(); i++) {
+            const protobuf::CircuitOp &op = circuit_.ops(i);
+            check_op(op, plaintexts_.size());
+            for (uint64_t input : op.inputs()) {
+                if (input >= next_value) {
+                    LOG_AND_THROW_STREAM("Circuit operation " << i << " reads value " << input
+                                                              << " before it is computed");
+                }
+            }
+            for (uint64_t output : op.outputs()) {
+                if (output != next_value || output >= num_values) {
+                    LOG_AND_THROW_STREAM("Circuit operation " << i << " produces value " << output << "; expected "
+                                                              << next_value);
+                }
+                producers.push_back(i);
+                next_value++;
+            }
+            if (op.type() == protobuf::CircuitOp::ENCRYPT) {
+                input_values_.push_back(op.outputs(0));
+                input_levels_.push_back(op.level());
+            }
+        }
+        if (next_value != num_values) {
+            LOG_AND_THROW_STREAM("Circuit produces " << next_value << " values; expected " << num_values);
+        }
+
+        // Find the operations which contribute to an output, starting from the outputs.
+        num_uses_.assign(num_values, 0);
+        vector<bool> is_live(num_values, false);
+        for (uint64_t output : circuit_.outputs()) {
+            if (output >= num_values) {
+                LOG_AND_THROW_STREAM("Circuit output " << output << " is not computed by the circuit");
+            }
+            num_uses_[output]++;
+            is_live[output] = true;
+        }
+        for (int i = circuit_.ops_size() - 1; i >= 0; i--) {
+            const protobuf::CircuitOp &op = circuit_.ops(i);
+            bool op_is_live = false;
+            for (uint64_t output : op.outputs()) {
+                op_is_live = op_is_live || is_live[output];
+            }
+            if (!op_is_live || op.type() == protobuf::CircuitOp::ENCRYPT) {
+                continue;
+            }
+            live_ops_.push_back(i);
+            for (uint64_t input : op.inputs()) {
+                num_uses_[input]++;
+                is_live[input] = true;
+            }
+        }
+        reverse(live_ops_.begin(), live_ops_.end());
+
+        num_pending_inputs_.assign(circuit_.ops_size(), 0);
+        consumers_.resize(circuit_.ops_size());
+        for (uint64_t consumer : live_ops_) {
+            for (uint64_t input : circuit_.ops(consumer).inputs()) {
+                uint64_t producer = producers[input];
+                if (circuit_.ops(producer).type() != protobuf::CircuitOp::ENCRYPT) {
+                    consumers_[producer].push_back(consumer);
+                    num_pending_inputs_[consumer]++;
+                }
+            }
+        }
+    }
+
+    int CircuitReplay::num_inputs() const {
+        return input_values_.size();
+    }
+
+    int CircuitReplay::num_outputs() const {
+        return circuit_.outputs_size();
+    }
+
+    vector<CKKSCiphertext> CircuitReplay::run(CKKSEvaluator &eval, const vector<CKKSCiphertext> &inputs) const {
+        if (inputs.size() != input_values_.size()) {
+            LOG_AND_THROW_STREAM("Circuit expects " << input_values_.size() << " inputs; got " << inputs.size());
+        }
+        if (eval.num_slots() != circuit_.num_slots()) {
+            LOG_AND_THROW_STREAM("Circuit was recorded with " << circuit_.num_slots()
+                                                              << " slots, but the evaluator has " << eval.num_slots()
+                                                              << " slots");
+        }
+
+        auto state = make_shared<RunState>(eval, circuit_.num_values(), circuit_.ops_size());
+        for (size_t i = 0; i < inputs.size(); i++) {
+            if (inputs[i].he_level() != input_levels_[i]) {
+                LOG_AND_THROW_STREAM("Circuit input " << i << " must be at level " << input_levels_[i] << "; got "
+                                                      << inputs[i].he_level());
+            }
+            if (num_uses_[input_values_[i]] > 0) {
+                state->values[input_values_[i]] = inputs[i];
+            }
+        }
+        for (size_t i = 0; i < num_uses_.size(); i++) {
+            state->uses[i] = num_uses_[i];
+        }
+        for (size_t i = 0; i < num_pending_inputs_.size(); i++) {
+            state->pending_inputs[i] = num_pending_inputs_[i];
+        }
+        state->remaining_ops = live_ops_.size();
+
+#ifdef DISABLE_PARALLELISM
+        for (uint64_t op : live_ops_) {
+            complete(*state, op);
+        }
+#else
+        if (!live_ops_.empty()) {
+            // collect the ready operations first, since they may finish (and update `pending_inputs`) immediately
+            vector<uint64_t> ready_ops;
+            for (uint64_t op : live_ops_) {
+                if (num_pending_inputs_[op] == 0) {
+                    ready_ops.push_back(op);
+                }
+            }
+            for (uint64_t op : ready_ops) {
+                scheduler_.enqueue([this, state, op]() { complete_from(state, op); });
+            }
+            state->done.get_future().wait();
+        }
+#endif
+
+        if (state->error) {
+            rethrow_exception(state->error);
+        }
+        vector<CKKSCiphertext> outputs;
+        for (uint64_t output : circuit_.outputs()) {
+            outputs.push_back(state->values[output]);
+        }
+        return outputs;
+    }
+
+    void CircuitReplay::complete_from(const shared_ptr<RunState> &state, uint64_t op) const {
+        while (true) {
+            complete(*state, op);
+
+            // Continue with the first consumer which is ready, rather than enqueueing it, so that a chain of
+            // operations runs on one thread while its inputs are still in cache.
+            int64_t next_op = -1;
+            for (uint64_t consumer : consumers_[op]) {
+                if (--state->pending_inputs[consumer] == 0) {
+                    if (next_op < 0) {
+                        next_op = consumer;
+                    } else {
+                        scheduler_.enqueue([this, state, consumer]() { complete_from(state, consumer); });
+                    }
+                }
+            }
+            if (--state->remaining_ops == 0) {
+                // `run` may return (and this object may be destroyed) as soon as `done` is set
+                state->done.set_value();
+                return;
+            }
+            if (next_op < 0) {
+                return;
+            }
+            op = next_op;
+        }
+    }
+
+    void CircuitReplay::complete(RunState &state, uint64_t op_index) const {
+        const protobuf::CircuitOp &op = circuit_.ops(op_index);
+        if (!state.failed) {
+            try {
+                CKKSEvaluator &eval = state.eval;
+                auto input = [&](int i) -> const CKKSCiphertext & { return state.values[op.inputs(i)]; };
+                CKKSCiphertext result;
+                switch (op.type()) {
+                    case protobuf::CircuitOp::ROTATE_LEFT:
+                        result = eval.rotate_left(input(0), op.steps(0));
+                        break;
+                    case protobuf::CircuitOp::ROTATE_RIGHT:
+                        result = eval.rotate_right(input(0), op.steps(0));
+                        break;
+                    case protobuf::CircuitOp::ROTATE_MANY: {
+                        vector<CKKSCiphertext> rotated =
+                            eval.rotate_many(input(0), vector<int>(op.steps().begin(), op.steps().end()));
+                        for (int i = 0; i < op.outputs_size(); i++) {
+                            state.values[op.outputs(i)] = move(rotated[i]);
+                        }
+                        break;
+                    }
+                    case protobuf::CircuitOp::NEGATE:
+                        result = eval.negate(input(0));
+                        break;
+                    case protobuf::CircuitOp::ADD:
+                        result = eval.add(input(0), input(1));
+                        break;
+                    case protobuf::CircuitOp::ADD_PLAIN_SCALAR:
+                        result = eval.add_plain(input(0), op.scalar());
+                        break;
+                    case protobuf::CircuitOp::ADD_PLAIN:
+                        result = eval.add_plain(input(0), plaintexts_[op.plaintext()]);
+                        break;
+                    case protobuf::CircuitOp::SUB:
+                        result = eval.sub(input(0), input(1));
+                        break;
+                    case protobuf::CircuitOp::SUB_PLAIN_SCALAR:
+                        result = eval.sub_plain(input(0), op.scalar());
+                        break;
+                    case protobuf::CircuitOp::SUB_PLAIN:
+                        result = eval.sub_plain(input(0), plaintexts_[op.plaintext()]);
+                        break;
+                    case protobuf::CircuitOp::MULTIPLY:
+                        result = eval.multiply(input(0), input(1));
+                        break;
+                    case protobuf::CircuitOp::MULTIPLY_PLAIN_SCALAR:
+                        result = eval.multiply_plain(input(0), op.scalar());
+                        break;
+                    case protobuf::CircuitOp::MULTIPLY_PLAIN:
+                        result = eval.multiply_plain(input(0), plaintexts_[op.plaintext()]);
+                        break;
+                    case protobuf::CircuitOp::SQUARE:
+                        result = eval.square(input(0));
+                        break;
+                    case protobuf::CircuitOp::MULTIPLY_RELIN_RESCALE:
+                        result = eval.multiply_relin_rescale(input(0), input(1));
+                        break;
+                    case protobuf::CircuitOp::MULTIPLY_PLAIN_RESCALE_SCALAR:
+                        result = eval.multiply_plain_rescale(input(0), op.scalar());
+                        break;
+                    case protobuf::CircuitOp::MULTIPLY_PLAIN_RESCALE:
+                        result = eval.multiply_plain_rescale(input(0), plaintexts_[op.plaintext()]);
+                        break;
+                    case protobuf::CircuitOp::INNER_PRODUCT: {
+                        int length = op.inputs_size() / 2;
+                        vector<CKKSCiphertext> cts1;
+                        vector<CKKSCiphertext> cts2;
+                        for (int i = 0; i < length; i++) {
+                            cts1.push_back(input(i));
+                            cts2.push_back(input(length + i));
+                        }
+                        result = eval.inner_product(cts1, cts2);
+                        break;
+                    }
+                    case protobuf::CircuitOp::REDUCE_LEVEL_TO:
+                        result = eval.reduce_level_to(input(0), op.level());
+                        break;
+                    case protobuf::CircuitOp::RESCALE_TO_NEXT:
+                        result = eval.rescale_to_next(input(0));
+                        break;
+                    case protobuf::CircuitOp::RELINEARIZE:
+                        result = input(0);
+                        eval.relinearize_inplace(result);
+                        break;
+                    default:
+                        // encryptions are replaced by the inputs before the circuit runs, and are never live
+                        LOG_AND_THROW_STREAM("Unexpected circuit operation type: " << op.type());
+                }
+                if (op.type() != protobuf::CircuitOp::ROTATE_MANY) {
+                    state.values[op.outputs(0)] = move(result);
+                }
+            } catch (...) {
+                scoped_lock lock(state.error_mutex);
+                if (!state.error) {
+                    state.error = current_exception();
+                }
+                state.failed = true;
+            }
+        }
+
+        // Release inputs which have no remaining uses, and outputs which are never used.
+        for (uint64_t input : op.inputs()) {
+            if (--state.uses[input] == 0) {
+                state.values[input] = CKKSCiphertext();
+            }
+        }
+        for (uint64_t output : op.outputs()) {
+            if (num_uses_[output] == 0) {
+                state.values[output] = CKKSCiphertext();
+            }
+        }
+    }
+}  // namespace hit
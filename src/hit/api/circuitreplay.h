@@ -0,0 +1,83 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "../scheduler.h"
+#include "ciphertext.h"
+#include "evaluator.h"
+#include "hit/protobuf/circuit.pb.h"
+
+namespace hit {
+
+    /* Runs a circuit recorded by the CircuitRecorder evaluator on another evaluator (e.g., HomomorphicEval).
+     *
+     * Operations are scheduled as a dataflow graph: an operation runs as soon as all of its inputs have been
+     * computed, so independent operations run in parallel on a TaskScheduler. When an operation finishes, the
+     * thread which ran it continues with one of the operations it made ready, and enqueues the rest for idle
+     * threads to pick up. Each intermediate ciphertext is released as soon as the last operation which reads
+     * it has finished, and operations which do not contribute to an output of the circuit are skipped.
+     *
+     * When HIT is built with DISABLE_PARALLELISM, operations run sequentially in the order they were recorded.
+     */
+    class CircuitReplay {
+       public:
+        /* Load a circuit recorded by CircuitRecorder. At most `max_concurrency` operations run at once; if
+         * `max_concurrency` is 0, the limit is the number of hardware threads. This throws an exception if
+         * the circuit is malformed.
+         */
+        explicit CircuitReplay(const protobuf::Circuit &circuit, int max_concurrency = 0);
+
+        // Load a circuit from a stream containing a protobuf object
+        explicit CircuitReplay(std::istream &stream, int max_concurrency = 0);
+
+        CircuitReplay(const CircuitReplay &) = delete;
+        CircuitReplay &operator=(const CircuitReplay &) = delete;
+        CircuitReplay(CircuitReplay &&) = delete;
+        CircuitReplay &operator=(CircuitReplay &&) = delete;
+
+        // The number of ciphertexts encrypted by the recorded circuit
+        int num_inputs() const;
+
+        // The number of ciphertexts marked as outputs of the recorded circuit
+        int num_outputs() const;
+
+        /* Run the circuit with `eval`. `inputs` replace the recorded encryptions, in order, and must be at the
+         * recorded levels. Returns the outputs of the circuit, in the order they were marked. If an operation
+         * throws an exception, operations which have not started are skipped, and the first exception is
+         * rethrown once the running operations finish. This function is thread-safe.
+         */
+        std::vector<CKKSCiphertext> run(CKKSEvaluator &eval, const std::vector<CKKSCiphertext> &inputs) const;
+
+       private:
+        struct RunState;
+
+        void load(const protobuf::Circuit &circuit);
+
+        // Compute the outputs of `op`, then release any values which will not be read again
+        void complete(RunState &state, uint64_t op) const;
+
+        // Complete `op`, then each operation it makes ready; all but one of those are enqueued
+        void complete_from(const std::shared_ptr<RunState> &state, uint64_t op) const;
+
+        protobuf::Circuit circuit_;
+        std::vector<std::vector<double>> plaintexts_;
+        // the values produced by encryptions, and their levels
+        std::vector<uint64_t> input_values_;
+        std::vector<int> input_levels_;
+        // operations (other than encryptions) which contribute to an output, in the order they were recorded
+        std::vector<uint64_t> live_ops_;
+        // for each value, the number of times it is read by a live operation or returned as an output
+        std::vector<int> num_uses_;
+        // for each operation, the number of its inputs produced by an operation other than an encryption
+        std::vector<int> num_pending_inputs_;
+        // for each operation, the live operations which read one of its outputs (once for each read)
+        std::vector<std::vector<uint64_t>> consumers_;
+        TaskScheduler scheduler_;
+    };
+}  // namespace hit
@@ -7,6 +7,13 @@
 
 #include "context.h"
 
+#include <exception>
+#include <future>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <tuple>
+
 #include "hit/common.h"
 
 using namespace std;
@@ -78,9 +85,89 @@ namespace hit {
             // for large parameter sets, see https://github.com/microsoft/SEAL/issues/84
             seal_ctx = make_shared<SEALContext>(ckks_params.params, true, sec_level_type::none);
         }
+
+        levels_.resize(num_qi());
+        for (auto context_data = seal_ctx->first_context_data(); context_data != nullptr;
+             context_data = context_data->next_context_data()) {
+            size_t level = context_data->chain_index();
+            if (level < levels_.size()) {
+                levels_[level].context_data = context_data;
+                levels_[level].parms_id = context_data->parms_id();
+                levels_[level].last_prime = context_data->parms().coeff_modulus().back().value();
+            }
+        }
+        double log_modulus = 0;
+        for (auto &level : levels_) {
+            log_modulus += log2(level.last_prime);
+            level.log_modulus = log_modulus;
+        }
+        // order of operations is very important: floating point arithmetic is not associative
+        double scale = pow(2, log_scale());
+        for (int i = max_ciphertext_level(); i >= 0; i--) {
+            levels_[i].fresh_scale = scale;
+            scale = (scale * scale) / static_cast<double>(levels_[i].last_prime);
+        }
+
         validateContext();
     }
 
+    shared_ptr<HEContext> HEContext::shared(const CKKSParams &params) {
+        // Contexts are identified by the serialized SEAL parameters, together with the HIT parameters
+        using RegistryKey = tuple<string, int, bool>;
+        struct RegistryEntry {
+            weak_ptr<HEContext> context;
+            // valid while the context is being constructed, so concurrent callers wait for that construction
+            shared_future<shared_ptr<HEContext>> constructing;
+        };
+        static mutex registry_mutex;
+        static map<RegistryKey, RegistryEntry> registry;
+
+        ostringstream seal_params;
+        params.params.save(seal_params, compr_mode_type::none);
+        RegistryKey key(seal_params.str(), params.log_scale(), params.use_std_params());
+
+        unique_lock lock(registry_mutex);
+        RegistryEntry &entry = registry[key];
+        shared_ptr<HEContext> context = entry.context.lock();
+        if (context != nullptr) {
+            return context;
+        }
+        if (entry.constructing.valid()) {
+            shared_future<shared_ptr<HEContext>> constructing = entry.constructing;
+            lock.unlock();
+            return constructing.get();
+        }
+
+        // Construct the context without holding the lock, so contexts for other parameters can be
+        // constructed (or looked up) concurrently.
+        promise<shared_ptr<HEContext>> constructed;
+        entry.constructing = constructed.get_future().share();
+        lock.unlock();
+        try {
+            context = make_shared<HEContext>(params);
+        } catch (...) {
+            lock.lock();
+            // later callers try again
+            registry[key].constructing = shared_future<shared_ptr<HEContext>>();
+            lock.unlock();
+            constructed.set_exception(current_exception());
+            throw;
+        }
+
+        lock.lock();
+        RegistryEntry &constructed_entry = registry[key];
+        constructed_entry.context = context;
+        constructed_entry.constructing = shared_future<shared_ptr<HEContext>>();
+        // drop entries for contexts which have been destroyed
+        for (auto it = registry.begin(); it != registry.end();) {
+            bool unused = it->second.context.expired() && !it->second.constructing.valid();
+            it = unused ? registry.erase(it) : next(it);
+        }
+        lock.unlock();
+        constructed.set_value(context);
+        return context;
+    }
+
     int HEContext::max_ciphertext_level() const {
         return ckks_params.max_ct_level();
     }
@@ -93,7 +180,7 @@ namespace hit {
         if (he_level > max_ciphertext_level()) {
             LOG_AND_THROW_STREAM("Q_i index-out-of-bounds exception");
         }
-        return get_context_data(he_level)->parms().coeff_modulus().back().value();
+        return level_data(he_level).last_prime;
     }
 
     uint64_t HEContext::get_pi(int i) const {
@@ -112,10 +199,7 @@ namespace hit {
     }
 
     uint64_t HEContext::total_modulus_bits() const {
-        double total = 0;
-        for (int i = 0; i < num_qi(); i++) {
-            total += log2(get_qi(i));
-        }
+        double total = log_modulus(max_ciphertext_level());
         for (int i = 0; i < num_pi(); i++) {
             total += log2(get_pi(i));
         }
@@ -131,18 +215,27 @@ namespace hit {
         return ckks_params.log_scale();
     }
 
-    /*
-    Helper function: Get the context data for the ciphertext's level
-    */
+    double HEContext::log_modulus(int he_level) const {
+        return level_data(he_level).log_modulus;
+    }
+
+    double HEContext::fresh_scale(int he_level) const {
+        return level_data(he_level).fresh_scale;
+    }
+
     shared_ptr<const SEALContext::ContextData> HEContext::get_context_data(int level) const {
-        // get the context_data for this ciphertext level
-        // but do not use the ciphertext itself! Use the he_level,
-        // in case we are not doing ciphertext computations
-        auto context_data = seal_ctx->first_context_data();
-        while (context_data->chain_index() > level) {
-            // Step forward in the chain.
-            context_data = context_data->next_context_data();
+        return level_data(level).context_data;
+    }
+
+    const parms_id_type &HEContext::parms_id(int level) const {
+        return level_data(level).parms_id;
+    }
+
+    const HEContext::LevelData &HEContext::level_data(int he_level) const {
+        if (he_level < 0 || he_level > max_ciphertext_level()) {
+            LOG_AND_THROW_STREAM("Level " << he_level << " is out of bounds: levels must be between 0 and "
+                                          << max_ciphertext_level());
         }
-        return context_data;
+        return levels_[he_level];
     }
 }  // namespace hit
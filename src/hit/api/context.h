@@ -4,6 +4,7 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 #include "params.h"
@@ -20,6 +21,13 @@ namespace hit {
        public:
         explicit HEContext(CKKSParams params);
 
+        /* Returns a context for `params` which is shared with all other live callers using identical parameters,
+         * creating it if necessary. Constructing a context precomputes tables for every level, which is
+         * expensive for large parameters, so evaluators use this function rather than the constructor.
+         * A context is destroyed once no evaluator uses it. This function is thread-safe.
+         */
+        static std::shared_ptr<HEContext> shared(const CKKSParams &params);
+
         // HEContext(const seal::EncryptionParameters &params, int precision_bits, bool use_standard_params);
 
         // Maximum level of a ciphertext for these parameters. For a leveled-HE scheme,
@@ -56,11 +64,32 @@ namespace hit {
         // Log(scale) for these parameters
         int log_scale() const;
 
+        // The sum of log2(Q_i) for i in [0, he_level]: the size of the ciphertext modulus at he_level, in bits
+        double log_modulus(int he_level) const;
+
+        // The nominal scale of a ciphertext freshly encrypted at he_level
+        double fresh_scale(int he_level) const;
+
         CKKSParams ckks_params;
         std::shared_ptr<seal::SEALContext> seal_ctx;
         std::shared_ptr<const seal::SEALContext::ContextData> get_context_data(int level) const;
+        const seal::parms_id_type &parms_id(int level) const;
 
        private:
+        // Per-level data, computed once at construction. SEAL only provides these through the modulus chain.
+        struct LevelData {
+            std::shared_ptr<const seal::SEALContext::ContextData> context_data;
+            seal::parms_id_type parms_id;
+            uint64_t last_prime;
+            double log_modulus;
+            double fresh_scale;
+        };
+
+        // levels_[i] holds the data for he_level i
+        std::vector<LevelData> levels_;
+
         void validateContext() const;
+
+        const LevelData &level_data(int he_level) const;
     };
 }  // namespace hit
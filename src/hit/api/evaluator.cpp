@@ -17,6 +17,25 @@ using namespace std;
 
 namespace hit {
 
+    // default implementation: encrypt each vector serially
+    vector<CKKSCiphertext> CKKSEvaluator::encrypt_many(const vector<vector<double>> &coeffs) {
+        vector<CKKSCiphertext> cts;
+        cts.reserve(coeffs.size());
+        for (const auto &c : coeffs) {
+            cts.push_back(encrypt(c));
+        }
+        return cts;
+    }
+
+    vector<CKKSCiphertext> CKKSEvaluator::encrypt_many(const vector<vector<double>> &coeffs, int level) {
+        vector<CKKSCiphertext> cts;
+        cts.reserve(coeffs.size());
+        for (const auto &c : coeffs) {
+            cts.push_back(encrypt(c, level));
+        }
+        return cts;
+    }
+
     vector<double> CKKSEvaluator::decrypt(const CKKSCiphertext &ct) {
         return decrypt(ct, false);
     }
@@ -25,6 +44,14 @@ namespace hit {
         LOG_AND_THROW_STREAM("Decrypt can only be called with Homomorphic or Debug evaluators");
     }
 
+    // default implementation: decrypt each ciphertext serially
+    void CKKSEvaluator::decrypt_many(const vector<const CKKSCiphertext *> &cts,
+                                     const function<void(int, const vector<double> &)> &consume) {
+        for (int i = 0; i < cts.size(); i++) {
+            consume(i, decrypt(*cts[i], true));
+        }
+    }
+
     CKKSCiphertext CKKSEvaluator::rotate_right(const CKKSCiphertext &ct, int steps) {
         CKKSCiphertext output = ct;
         rotate_right_inplace(output, steps);
@@ -39,6 +66,7 @@ namespace hit {
             LOG_AND_THROW_STREAM("Input to rotate_right must be a linear ciphertext");
         }
         VLOG(VLOG_EVAL) << "Rotate " << abs(steps) << " steps right.";
+        ct.seeded_ct_.reset();
         rotate_right_inplace_internal(ct, steps);
         print_stats(ct);
     }
@@ -57,10 +85,37 @@ namespace hit {
             LOG_AND_THROW_STREAM("Input to rotate_left must be a linear ciphertext");
         }
         VLOG(VLOG_EVAL) << "Rotate " << abs(steps) << " steps left.";
+        ct.seeded_ct_.reset();
         rotate_left_inplace_internal(ct, steps);
         print_stats(ct);
     }
 
+    vector<CKKSCiphertext> CKKSEvaluator::rotate_many(const CKKSCiphertext &ct, const vector<int> &steps) {
+        if (ct.needs_relin()) {
+            LOG_AND_THROW_STREAM("Input to rotate_many must be a linear ciphertext");
+        }
+        VLOG(VLOG_EVAL) << "Rotate ciphertext by " << steps.size() << " different steps.";
+        vector<CKKSCiphertext> outputs(steps.size(), ct);
+        rotate_many_internal(ct, steps, outputs);
+        for (auto &output : outputs) {
+            output.seeded_ct_.reset();
+            print_stats(output);
+        }
+        return outputs;
+    }
+
+    // default implementation: rotate each copy independently
+    void CKKSEvaluator::rotate_many_internal(const CKKSCiphertext &, const vector<int> &steps,
+                                             vector<CKKSCiphertext> &outputs) {
+        for (int i = 0; i < steps.size(); i++) {
+            if (steps[i] > 0) {
+                rotate_left_inplace_internal(outputs[i], steps[i]);
+            } else if (steps[i] < 0) {
+                rotate_right_inplace_internal(outputs[i], -steps[i]);
+            }
+        }
+    }
+
     CKKSCiphertext CKKSEvaluator::negate(const CKKSCiphertext &ct) {
         CKKSCiphertext output = ct;
         negate_inplace(output);
@@ -69,6 +124,7 @@ namespace hit {
 
     void CKKSEvaluator::negate_inplace(CKKSCiphertext &ct) {
         VLOG(VLOG_EVAL) << "Negate";
+        ct.seeded_ct_.reset();
         negate_inplace_internal(ct);
         print_stats(ct);
     }
@@ -89,6 +145,7 @@ namespace hit {
             LOG_AND_THROW_STREAM("Inputs to add must be at the same level: " << ct1.he_level()
                                                                              << " != " << ct2.he_level());
         }
+        ct1.seeded_ct_.reset();
         add_inplace_internal(ct1, ct2);
         print_stats(ct1);
     }
@@ -101,6 +158,7 @@ namespace hit {
 
     void CKKSEvaluator::add_plain_inplace(CKKSCiphertext &ct, double scalar) {
         VLOG(VLOG_EVAL) << "Add scalar " << scalar << " to ciphertext";
+        ct.seeded_ct_.reset();
         add_plain_inplace_internal(ct, scalar);
         print_stats(ct);
     }
@@ -118,6 +176,7 @@ namespace hit {
                                  << " coefficients as the ciphertext has plaintext slots: "
                                  << "Expected " << ct.num_slots() << " coeffs, got " << plain.size());
         }
+        ct.seeded_ct_.reset();
         add_plain_inplace_internal(ct, plain);
         print_stats(ct);
     }
@@ -129,6 +188,7 @@ namespace hit {
         VLOG(VLOG_EVAL) << "Add ciphertext vector of size " << cts.size();
 
         CKKSCiphertext dest = cts[0];
+        dest.seeded_ct_.reset();
         for (int i = 1; i < cts.size(); i++) {
             if (cts[i].scale() != dest.scale()) {
                 LOG_AND_THROW_STREAM("Inputs to add_many must have the same scale: "
@@ -160,6 +220,7 @@ namespace hit {
             LOG_AND_THROW_STREAM("Inputs to sub must be at the same level: " << ct1.he_level()
                                                                              << " != " << ct2.he_level());
         }
+        ct1.seeded_ct_.reset();
         sub_inplace_internal(ct1, ct2);
         print_stats(ct1);
     }
@@ -172,6 +233,7 @@ namespace hit {
 
     void CKKSEvaluator::sub_plain_inplace(CKKSCiphertext &ct, double scalar) {
         VLOG(VLOG_EVAL) << "Subtract scalar " << scalar << " from ciphertext";
+        ct.seeded_ct_.reset();
         sub_plain_inplace_internal(ct, scalar);
         print_stats(ct);
     }
@@ -189,6 +251,7 @@ namespace hit {
                                  << " coefficients as the ciphertext has plaintext slots: "
                                  << "Expected " << ct.num_slots() << " coeffs, got " << plain.size());
         }
+        ct.seeded_ct_.reset();
         sub_plain_inplace_internal(ct, plain);
         print_stats(ct);
     }
@@ -215,6 +278,7 @@ namespace hit {
             LOG_AND_THROW_STREAM("Inputs to multiply must have the same scale: " << log2(ct1.scale()) << " bits != "
                                                                                  << log2(ct2.scale()) << " bits");
         }
+        ct1.seeded_ct_.reset();
         multiply_inplace_internal(ct1, ct2);
         ct1.needs_rescale_ = true;
         ct1.needs_relin_ = true;
@@ -233,6 +297,7 @@ namespace hit {
         if (ct.needs_rescale()) {
             LOG_AND_THROW_STREAM("Encrypted input to multiply_plain must have nominal scale");
         }
+        ct.seeded_ct_.reset();
         multiply_plain_inplace_internal(ct, scalar);
         ct.needs_rescale_ = true;
         ct.scale_ *= ct.scale_;
@@ -255,12 +320,126 @@ namespace hit {
         if (ct.needs_rescale()) {
             LOG_AND_THROW_STREAM("Encrypted input to multiply_plain must have nominal scale");
         }
+        ct.seeded_ct_.reset();
         multiply_plain_inplace_internal(ct, plain);
         ct.needs_rescale_ = true;
         ct.scale_ *= ct.scale_;
         print_stats(ct);
     }
 
+    CKKSCiphertext CKKSEvaluator::multiply_relin_rescale(const CKKSCiphertext &ct1, const CKKSCiphertext &ct2) {
+        CKKSCiphertext temp = ct1;
+        multiply_relin_rescale_inplace(temp, ct2);
+        return temp;
+    }
+
+    void CKKSEvaluator::multiply_relin_rescale_inplace(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) {
+        VLOG(VLOG_EVAL) << "Multiply, relinearize, and rescale ciphertexts";
+        if (ct1.needs_relin() || ct2.needs_relin()) {
+            LOG_AND_THROW_STREAM("Inputs to multiply_relin_rescale must be linear ciphertexts");
+        }
+        if (ct1.he_level() != ct2.he_level()) {
+            LOG_AND_THROW_STREAM("Inputs to multiply_relin_rescale must be at the same level: "
+                                 << ct1.he_level() << " != " << ct2.he_level());
+        }
+        if (ct1.needs_rescale() || ct2.needs_rescale()) {
+            LOG_AND_THROW_STREAM("Inputs to multiply_relin_rescale must have nominal scale");
+        }
+        if (ct1.scale() != ct2.scale()) {
+            LOG_AND_THROW_STREAM("Inputs to multiply_relin_rescale must have the same scale: "
+                                 << log2(ct1.scale()) << " bits != " << log2(ct2.scale()) << " bits");
+        }
+        ct1.seeded_ct_.reset();
+        multiply_relin_rescale_inplace_internal(ct1, ct2);
+        ct1.scale_ *= ct1.scale_;
+        ct1.needs_rescale_ = true;
+        rescale_metata_to_next(ct1);
+        print_stats(ct1);
+    }
+
+    CKKSCiphertext CKKSEvaluator::multiply_plain_rescale(const CKKSCiphertext &ct, double scalar) {
+        CKKSCiphertext output = ct;
+        multiply_plain_rescale_inplace(output, scalar);
+        return output;
+    }
+
+    void CKKSEvaluator::multiply_plain_rescale_inplace(CKKSCiphertext &ct, double scalar) {
+        VLOG(VLOG_EVAL) << "Multiply ciphertext by scalar " << scalar << " and rescale";
+        if (ct.needs_rescale()) {
+            LOG_AND_THROW_STREAM("Encrypted input to multiply_plain_rescale must have nominal scale");
+        }
+        ct.seeded_ct_.reset();
+        multiply_plain_rescale_inplace_internal(ct, scalar);
+        ct.scale_ *= ct.scale_;
+        ct.needs_rescale_ = true;
+        rescale_metata_to_next(ct);
+        print_stats(ct);
+    }
+
+    CKKSCiphertext CKKSEvaluator::multiply_plain_rescale(const CKKSCiphertext &ct, const vector<double> &plain) {
+        CKKSCiphertext output = ct;
+        multiply_plain_rescale_inplace(output, plain);
+        return output;
+    }
+
+    void CKKSEvaluator::multiply_plain_rescale_inplace(CKKSCiphertext &ct, const vector<double> &plain) {
+        VLOG(VLOG_EVAL) << "Multiply by plaintext and rescale";
+        if (ct.num_slots() != plain.size()) {
+            LOG_AND_THROW_STREAM("Public argument to multiply_plain_rescale must have exactly as many "
+                                 << " coefficients as the ciphertext has plaintext slots: "
+                                 << "Expected " << ct.num_slots() << " coeffs, got " << plain.size());
+        }
+        if (ct.needs_rescale()) {
+            LOG_AND_THROW_STREAM("Encrypted input to multiply_plain_rescale must have nominal scale");
+        }
+        ct.seeded_ct_.reset();
+        multiply_plain_rescale_inplace_internal(ct, plain);
+        ct.scale_ *= ct.scale_;
+        ct.needs_rescale_ = true;
+        rescale_metata_to_next(ct);
+        print_stats(ct);
+    }
+
+    CKKSCiphertext CKKSEvaluator::inner_product(const vector<CKKSCiphertext> &cts1,
+                                                const vector<CKKSCiphertext> &cts2) {
+        if (cts1.empty()) {
+            LOG_AND_THROW_STREAM("inner_product: vectors may not be empty.");
+        }
+        if (cts1.size() != cts2.size()) {
+            LOG_AND_THROW_STREAM("Inputs to inner_product must have the same length: " << cts1.size()
+                                                                                       << " != " << cts2.size());
+        }
+        VLOG(VLOG_EVAL) << "Inner product of ciphertext vectors of size " << cts1.size();
+
+        for (int i = 0; i < cts1.size(); i++) {
+            for (const CKKSCiphertext *ct : {&cts1[i], &cts2[i]}) {
+                if (ct->needs_relin()) {
+                    LOG_AND_THROW_STREAM("Inputs to inner_product must be linear ciphertexts");
+                }
+                if (ct->needs_rescale()) {
+                    LOG_AND_THROW_STREAM("Inputs to inner_product must have nominal scale");
+                }
+                if (ct->he_level() != cts1[0].he_level()) {
+                    LOG_AND_THROW_STREAM("Inputs to inner_product must be at the same level: "
+                                         << ct->he_level() << " != " << cts1[0].he_level());
+                }
+                if (ct->scale() != cts1[0].scale()) {
+                    LOG_AND_THROW_STREAM("Inputs to inner_product must have the same scale: "
+                                         << log2(ct->scale()) << " bits != " << log2(cts1[0].scale()) << " bits");
+                }
+            }
+        }
+
+        CKKSCiphertext output = cts1[0];
+        output.seeded_ct_.reset();
+        inner_product_internal(cts1, cts2, output);
+        output.scale_ *= output.scale_;
+        output.needs_rescale_ = true;
+        rescale_metata_to_next(output);
+        print_stats(output);
+        return output;
+    }
+
     CKKSCiphertext CKKSEvaluator::square(const CKKSCiphertext &ct) {
         CKKSCiphertext output = ct;
         square_inplace(output);
@@ -275,6 +454,7 @@ namespace hit {
         if (ct.needs_rescale()) {
             LOG_AND_THROW_STREAM("Input to square must have nominal scale");
         }
+        ct.seeded_ct_.reset();
         square_inplace_internal(ct);
         ct.needs_rescale_ = true;
         ct.needs_relin_ = true;
@@ -316,6 +496,7 @@ namespace hit {
         if (ct.needs_rescale()) {
             LOG_AND_THROW_STREAM("Input to reduce_level_to must have nominal scale");
         }
+        ct.seeded_ct_.reset();
         reduce_level_to_inplace_internal(ct, level);
         // updates he_level and scale
         reduce_metadata_to_level(ct, level);
@@ -333,6 +514,7 @@ namespace hit {
         if (!ct.needs_rescale()) {
             LOG_AND_THROW_STREAM("Input to rescale_to_next_inplace must have squared scale");
         }
+        ct.seeded_ct_.reset();
         rescale_to_next_inplace_internal(ct);
         rescale_metata_to_next(ct);
         print_stats(ct);
@@ -343,11 +525,15 @@ namespace hit {
         if (!ct.needs_relin()) {
             LOG_AND_THROW_STREAM("Input to relinearize_inplace must be a linear ciphertext");
         }
+        ct.seeded_ct_.reset();
         relinearize_inplace_internal(ct);
         ct.needs_relin_ = false;
         print_stats(ct);
     }
 
+    // Evaluators must not update the ciphertext metadata in reduce_level_to_inplace_internal;
+    // this function is the single source of truth for the nominal scale at the target level.
+    // Order of operations matches the scale computation for encryption at a lower level.
     void CKKSEvaluator::reduce_metadata_to_level(CKKSCiphertext &ct, int level) {
         while (ct.he_level() > level) {
             ct.scale_ *= ct.scale();
@@ -363,6 +549,76 @@ namespace hit {
         ct.needs_rescale_ = false;
     }
 
+    /* Default implementations of the fused operations. Each step of the fused operation
+     * expects the metadata of its own input, so we temporarily update the metadata between
+     * steps as the public API would, and then restore the input metadata since
+     * internal functions should not update the ciphertext metadata.
+     */
+    void CKKSEvaluator::multiply_relin_rescale_inplace_internal(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) {
+        double input_scale = ct1.scale();
+
+        multiply_inplace_internal(ct1, ct2);
+        ct1.scale_ *= ct1.scale_;
+        ct1.needs_rescale_ = true;
+        ct1.needs_relin_ = true;
+        relinearize_inplace_internal(ct1);
+        ct1.needs_relin_ = false;
+        rescale_to_next_inplace_internal(ct1);
+
+        ct1.scale_ = input_scale;
+        ct1.needs_rescale_ = false;
+    }
+
+    void CKKSEvaluator::multiply_plain_rescale_inplace_internal(CKKSCiphertext &ct, double scalar) {
+        double input_scale = ct.scale();
+
+        multiply_plain_inplace_internal(ct, scalar);
+        ct.scale_ *= ct.scale_;
+        ct.needs_rescale_ = true;
+        rescale_to_next_inplace_internal(ct);
+
+        ct.scale_ = input_scale;
+        ct.needs_rescale_ = false;
+    }
+
+    void CKKSEvaluator::multiply_plain_rescale_inplace_internal(CKKSCiphertext &ct, const vector<double> &plain) {
+        double input_scale = ct.scale();
+
+        multiply_plain_inplace_internal(ct, plain);
+        ct.scale_ *= ct.scale_;
+        ct.needs_rescale_ = true;
+        rescale_to_next_inplace_internal(ct);
+
+        ct.scale_ = input_scale;
+        ct.needs_rescale_ = false;
+    }
+
+    // Default implementation of inner_product: sum the (unrelinearized) products, then relinearize
+    // and rescale once. As above, the metadata is updated between steps and restored at the end.
+    void CKKSEvaluator::inner_product_internal(const vector<CKKSCiphertext> &cts1, const vector<CKKSCiphertext> &cts2,
+                                               CKKSCiphertext &output) {
+        double input_scale = output.scale();
+
+        multiply_inplace_internal(output, cts2[0]);
+        output.scale_ *= output.scale_;
+        output.needs_rescale_ = true;
+        output.needs_relin_ = true;
+        for (int i = 1; i < cts1.size(); i++) {
+            CKKSCiphertext prod = cts1[i];
+            multiply_inplace_internal(prod, cts2[i]);
+            prod.scale_ *= prod.scale_;
+            prod.needs_rescale_ = true;
+            prod.needs_relin_ = true;
+            add_inplace_internal(output, prod);
+        }
+        relinearize_inplace_internal(output);
+        output.needs_relin_ = false;
+        rescale_to_next_inplace_internal(output);
+
+        output.scale_ = input_scale;
+        output.needs_rescale_ = false;
+    }
+
     // default implementation for evaluators which don't use SEAL
     uint64_t CKKSEvaluator::get_last_prime_internal(const CKKSCiphertext &ct) const {
         if (ct.needs_rescale()) {
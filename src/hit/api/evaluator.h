@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <functional>
 #include <future>
 #include <shared_mutex>
 
@@ -49,6 +50,11 @@ namespace hit {
         virtual CKKSCiphertext encrypt(const std::vector<double> &coeffs) = 0;
         virtual CKKSCiphertext encrypt(const std::vector<double> &coeffs, int level) = 0;
 
+        // Encrypt a batch of (full-dimensional) vectors, all at the same level. This is equivalent to
+        // calling `encrypt` on each vector, but evaluators may encrypt the batch in parallel.
+        virtual std::vector<CKKSCiphertext> encrypt_many(const std::vector<std::vector<double>> &coeffs);
+        virtual std::vector<CKKSCiphertext> encrypt_many(const std::vector<std::vector<double>> &coeffs, int level);
+
         // Decrypt a ciphertext to (approximately) recover the plaintext coefficients.
         // This function will log a message if you try to decrypt a ciphertext which
         // is not at level 0. Sometimes it is expected for a ciphertext to be at a higher
@@ -56,6 +62,14 @@ namespace hit {
         virtual std::vector<double> decrypt(const CKKSCiphertext &ct);
         virtual std::vector<double> decrypt(const CKKSCiphertext &ct, bool suppress_warnings);
 
+        // Decrypt a batch of ciphertexts. Rather than returning a new vector for each plaintext,
+        // `consume(i, coeffs)` is called with the decrypted coefficients of *cts[i], so that the caller
+        // can write them directly to their final destination. Evaluators may decrypt in parallel,
+        // so `consume` may be called concurrently (with distinct indices) and in any order.
+        // The caller is responsible for any level warnings; see `decrypt`.
+        virtual void decrypt_many(const std::vector<const CKKSCiphertext *> &cts,
+                                  const std::function<void(int, const std::vector<double> &)> &consume);
+
         // Get the number of plaintext slots expected by this evaluator
         virtual int num_slots() const = 0;
 
@@ -95,6 +109,20 @@ namespace hit {
          */
         void rotate_left_inplace(CKKSCiphertext &ct, int steps);
 
+        /* Rotate a plaintext vector cyclically by several different amounts at once.
+         * Positive steps rotate left and negative steps rotate right, which matches the
+         * `galois_steps` convention used to generate rotation keys:
+         *     rotate_many(<1,2,3,4>, [1, -1]) = [<2,3,4,1>, <4,1,2,3>]
+         * Evaluators may share work between the rotations; in particular, the homomorphic
+         * evaluator only decomposes the input for key switching once. This is usually much
+         * faster than calling rotate_left/rotate_right on the same input repeatedly.
+         * Input: A linear ciphertext with nominal or squared scale
+         *        and a list of steps.
+         * Output: A list of ciphertexts with the same properties as the input, where
+         *         the i^th output is the input rotated by steps[i].
+         */
+        std::vector<CKKSCiphertext> rotate_many(const CKKSCiphertext &ct, const std::vector<int> &steps);
+
         /* Add a scalar to each plaintext slot.
          * Input: An arbitrary ciphertext (any degree and any scale) and a public scalar
          * Output: A ciphertext with the same properties as the input.
@@ -252,6 +280,60 @@ namespace hit {
          */
         void multiply_inplace(CKKSCiphertext &ct1, const CKKSCiphertext &ct2);
 
+        /* Multiply two encrypted plaintexts component-wise, relinearize, and rescale.
+         * This is equivalent to calling multiply, relinearize_inplace, and rescale_to_next_inplace,
+         * but is more efficient since inputs are validated once and no intermediate
+         * (quadratic) result is exposed.
+         * Input: Two linear ciphertexts at the same level i>0, with nominal scales.
+         * Output: A linear ciphertext with nominal scale and level i-1.
+         */
+        CKKSCiphertext multiply_relin_rescale(const CKKSCiphertext &ct1, const CKKSCiphertext &ct2);
+
+        /* Multiply two encrypted plaintexts component-wise, relinearize, and rescale.
+         * Input: Two linear ciphertexts at the same level i>0, with nominal scales.
+         * Output (Inplace): A linear ciphertext with nominal scale and level i-1.
+         */
+        void multiply_relin_rescale_inplace(CKKSCiphertext &ct1, const CKKSCiphertext &ct2);
+
+        /* Multiply each plaintext slot by a scalar, then rescale.
+         * Input: A linear or quadratic ciphertext with nominal scale and level i>0.
+         * Output: A ciphertext with the same ciphertext degree as the input,
+         *         with nominal scale and level i-1.
+         */
+        CKKSCiphertext multiply_plain_rescale(const CKKSCiphertext &ct, double scalar);
+
+        /* Multiply each plaintext slot by a scalar, then rescale.
+         * Input: A linear or quadratic ciphertext with nominal scale and level i>0.
+         * Output (Inplace): A ciphertext with the same ciphertext degree as the input,
+         *                   with nominal scale and level i-1.
+         */
+        void multiply_plain_rescale_inplace(CKKSCiphertext &ct, double scalar);
+
+        /* Multiply the encrypted plaintext and the public plaintext component-wise, then rescale.
+         * Input: A linear or quadratic ciphertext with nominal scale and level i>0.
+         * Output: A ciphertext with the same ciphertext degree as the input,
+         *         with nominal scale and level i-1.
+         */
+        CKKSCiphertext multiply_plain_rescale(const CKKSCiphertext &ct, const std::vector<double> &plain);
+
+        /* Multiply the encrypted plaintext and the public plaintext component-wise, then rescale.
+         * Input: A linear or quadratic ciphertext with nominal scale and level i>0.
+         * Output (Inplace): A ciphertext with the same ciphertext degree as the input,
+         *                   with nominal scale and level i-1.
+         */
+        void multiply_plain_rescale_inplace(CKKSCiphertext &ct, const std::vector<double> &plain);
+
+        /* Compute the component-wise inner product sum_i cts1[i]*cts2[i].
+         * This is equivalent to multiplying each pair of ciphertexts, relinearizing and rescaling
+         * each product, and summing the results. However, the quadratic products are summed
+         * before relinearizing and rescaling, so the inner product requires only a single
+         * relinearization and a single rescale, regardless of the length of the inputs.
+         * Input: Two non-empty vectors of the same length, containing linear ciphertexts
+         *        with nominal scales. All ciphertexts must be at the same level i>0.
+         * Output: A linear ciphertext with nominal scale and level i-1.
+         */
+        CKKSCiphertext inner_product(const std::vector<CKKSCiphertext> &cts1, const std::vector<CKKSCiphertext> &cts2);
+
         /* Square each plaintext coefficient.
          * Input: A linear ciphertext with nominal scale.
          * Output: A quadratic ciphertext whose level is the same as the input,
@@ -348,6 +430,9 @@ namespace hit {
        protected:
         virtual void rotate_right_inplace_internal(CKKSCiphertext &ct, int steps);
         virtual void rotate_left_inplace_internal(CKKSCiphertext &ct, int steps);
+        // `outputs` has one copy of `ct` for each step
+        virtual void rotate_many_internal(const CKKSCiphertext &ct, const std::vector<int> &steps,
+                                          std::vector<CKKSCiphertext> &outputs);
         virtual void negate_inplace_internal(CKKSCiphertext &ct);
         virtual void add_inplace_internal(CKKSCiphertext &ct1, const CKKSCiphertext &ct2);
         virtual void add_plain_inplace_internal(CKKSCiphertext &ct, double scalar);
@@ -359,6 +444,14 @@ namespace hit {
         virtual void multiply_plain_inplace_internal(CKKSCiphertext &ct, double scalar);
         virtual void multiply_plain_inplace_internal(CKKSCiphertext &ct, const std::vector<double> &plain);
         virtual void square_inplace_internal(CKKSCiphertext &ct);
+        // The default implementations of the fused operations compose the internal functions above.
+        // Like all internal functions, they must not update the ciphertext metadata.
+        virtual void multiply_relin_rescale_inplace_internal(CKKSCiphertext &ct1, const CKKSCiphertext &ct2);
+        virtual void multiply_plain_rescale_inplace_internal(CKKSCiphertext &ct, double scalar);
+        virtual void multiply_plain_rescale_inplace_internal(CKKSCiphertext &ct, const std::vector<double> &plain);
+        // `output` is a copy of cts1[0]
+        virtual void inner_product_internal(const std::vector<CKKSCiphertext> &cts1,
+                                            const std::vector<CKKSCiphertext> &cts2, CKKSCiphertext &output);
         virtual void reduce_level_to_inplace_internal(CKKSCiphertext &ct, int level);
         virtual void rescale_to_next_inplace_internal(CKKSCiphertext &ct);
         virtual void relinearize_inplace_internal(CKKSCiphertext &ct);
@@ -0,0 +1,228 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "circuitrecorder.h"
+
+#include <glog/logging.h>
+
+#include "../../common.h"
+
+using namespace std;
+
+namespace hit {
+
+    CircuitRecorder::CircuitRecorder(int num_slots, int max_ct_level)
+        : num_slots_(num_slots), max_ct_level_(max_ct_level) {
+        if (num_slots <= 0) {
+            LOG_AND_THROW_STREAM("num_slots must be positive; got " << num_slots);
+        }
+        if (max_ct_level < 0) {
+            LOG_AND_THROW_STREAM("max_ct_level must be non-negative; got " << max_ct_level);
+        }
+        circuit_.set_num_slots(num_slots);
+        circuit_.set_num_values(0);
+    }
+
+    CKKSCiphertext CircuitRecorder::encrypt(const vector<double> &coeffs) {
+        return encrypt(coeffs, max_ct_level_);
+    }
+
+    CKKSCiphertext CircuitRecorder::encrypt(const vector<double> &, int level) {
+        if (level < 0 || level > max_ct_level_) {
+            LOG_AND_THROW_STREAM("Invalid encryption level: " << level << "; max_ct_level is " << max_ct_level_);
+        }
+        CKKSCiphertext destination;
+        destination.he_level_ = level;
+        destination.num_slots_ = num_slots_;
+        destination.initialized = true;
+
+        scoped_lock lock(mutex_);
+        record(protobuf::CircuitOp::ENCRYPT, {}, {&destination})->set_level(level);
+        return destination;
+    }
+
+    void CircuitRecorder::mark_output(const CKKSCiphertext &ct) {
+        if (ct.circuit_value_ < 0) {
+            LOG_AND_THROW_STREAM("Circuit outputs must be produced by the CircuitRecorder");
+        }
+        scoped_lock lock(mutex_);
+        if (static_cast<uint64_t>(ct.circuit_value_) >= circuit_.num_values()) {
+            LOG_AND_THROW_STREAM("Circuit outputs must be produced by this CircuitRecorder");
+        }
+        circuit_.add_outputs(ct.circuit_value_);
+    }
+
+    protobuf::Circuit *CircuitRecorder::serialize() const {
+        shared_lock lock(mutex_);
+        return new protobuf::Circuit(circuit_);
+    }
+
+    void CircuitRecorder::save(ostream &stream) const {
+        protobuf::Circuit *proto_circuit = serialize();
+        proto_circuit->SerializeToOstream(&stream);
+        delete proto_circuit;
+    }
+
+    int CircuitRecorder::num_slots() const {
+        return num_slots_;
+    }
+
+    protobuf::CircuitOp *CircuitRecorder::record(protobuf::CircuitOp::Type type,
+                                                 const vector<const CKKSCiphertext *> &inputs,
+                                                 const vector<CKKSCiphertext *> &outputs) {
+        for (const CKKSCiphertext *input : inputs) {
+            if (input->circuit_value_ < 0) {
+                LOG_AND_THROW_STREAM("Inputs to a recorded circuit must be encrypted by the CircuitRecorder");
+            }
+        }
+        protobuf::CircuitOp *op = circuit_.add_ops();
+        op->set_type(type);
+        for (const CKKSCiphertext *input : inputs) {
+            op->add_inputs(input->circuit_value_);
+        }
+        // Inputs are read before outputs are assigned, since an output may alias an input.
+        for (CKKSCiphertext *output : outputs) {
+            uint64_t value = circuit_.num_values();
+            circuit_.set_num_values(value + 1);
+            op->add_outputs(value);
+            output->circuit_value_ = static_cast<int64_t>(value);
+        }
+        return op;
+    }
+
+    uint64_t CircuitRecorder::plaintext_index(const vector<double> &plain) {
+        auto it = plaintext_indices_.find(plain);
+        if (it != plaintext_indices_.end()) {
+            return it->second;
+        }
+        uint64_t index = circuit_.plaintexts_size();
+        protobuf::CircuitPlaintext *proto_plain = circuit_.add_plaintexts();
+        for (double coeff : plain) {
+            proto_plain->add_coeffs(coeff);
+        }
+        plaintext_indices_[plain] = index;
+        return index;
+    }
+
+    void CircuitRecorder::rotate_right_inplace_internal(CKKSCiphertext &ct, int steps) {
+        scoped_lock lock(mutex_);
+        record(protobuf::CircuitOp::ROTATE_RIGHT, {&ct}, {&ct})->add_steps(steps);
+    }
+
+    void CircuitRecorder::rotate_left_inplace_internal(CKKSCiphertext &ct, int steps) {
+        scoped_lock lock(mutex_);
+        record(protobuf::CircuitOp::ROTATE_LEFT, {&ct}, {&ct})->add_steps(steps);
+    }
+
+    void CircuitRecorder::rotate_many_internal(const CKKSCiphertext &ct, const vector<int> &steps,
+                                               vector<CKKSCiphertext> &outputs) {
+        vector<CKKSCiphertext *> output_ptrs;
+        for (auto &output : outputs) {
+            output_ptrs.push_back(&output);
+        }
+        scoped_lock lock(mutex_);
+        protobuf::CircuitOp *op = record(protobuf::CircuitOp::ROTATE_MANY, {&ct}, output_ptrs);
+        for (int step : steps) {
+            op->add_steps(step);
+        }
+    }
+
+    void CircuitRecorder::negate_inplace_internal(CKKSCiphertext &ct) {
+        scoped_lock lock(mutex_);
+        record(protobuf::CircuitOp::NEGATE, {&ct}, {&ct});
+    }
+
+    void CircuitRecorder::add_inplace_internal(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) {
+        scoped_lock lock(mutex_);
+        record(protobuf::CircuitOp::ADD, {&ct1, &ct2}, {&ct1});
+    }
+
+    void CircuitRecorder::add_plain_inplace_internal(CKKSCiphertext &ct, double scalar) {
+        scoped_lock lock(mutex_);
+        record(protobuf::CircuitOp::ADD_PLAIN_SCALAR, {&ct}, {&ct})->set_scalar(scalar);
+    }
+
+    void CircuitRecorder::add_plain_inplace_internal(CKKSCiphertext &ct, const vector<double> &plain) {
+        scoped_lock lock(mutex_);
+        record(protobuf::CircuitOp::ADD_PLAIN, {&ct}, {&ct})->set_plaintext(plaintext_index(plain));
+    }
+
+    void CircuitRecorder::sub_inplace_internal(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) {
+        scoped_lock lock(mutex_);
+        record(protobuf::CircuitOp::SUB, {&ct1, &ct2}, {&ct1});
+    }
+
+    void CircuitRecorder::sub_plain_inplace_internal(CKKSCiphertext &ct, double scalar) {
+        scoped_lock lock(mutex_);
+        record(protobuf::CircuitOp::SUB_PLAIN_SCALAR, {&ct}, {&ct})->set_scalar(scalar);
+    }
+
+    void CircuitRecorder::sub_plain_inplace_internal(CKKSCiphertext &ct, const vector<double> &plain) {
+        scoped_lock lock(mutex_);
+        record(protobuf::CircuitOp::SUB_PLAIN, {&ct}, {&ct})->set_plaintext(plaintext_index(plain));
+    }
+
+    void CircuitRecorder::multiply_inplace_internal(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) {
+        scoped_lock lock(mutex_);
+        record(protobuf::CircuitOp::MULTIPLY, {&ct1, &ct2}, {&ct1});
+    }
+
+    void CircuitRecorder::multiply_plain_inplace_internal(CKKSCiphertext &ct, double scalar) {
+        scoped_lock lock(mutex_);
+        record(protobuf::CircuitOp::MULTIPLY_PLAIN_SCALAR, {&ct}, {&ct})->set_scalar(scalar);
+    }
+
+    void CircuitRecorder::multiply_plain_inplace_internal(CKKSCiphertext &ct, const vector<double> &plain) {
+        scoped_lock lock(mutex_);
+        record(protobuf::CircuitOp::MULTIPLY_PLAIN, {&ct}, {&ct})->set_plaintext(plaintext_index(plain));
+    }
+
+    void CircuitRecorder::square_inplace_internal(CKKSCiphertext &ct) {
+        scoped_lock lock(mutex_);
+        record(protobuf::CircuitOp::SQUARE, {&ct}, {&ct});
+    }
+
+    void CircuitRecorder::multiply_relin_rescale_inplace_internal(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) {
+        scoped_lock lock(mutex_);
+        record(protobuf::CircuitOp::MULTIPLY_RELIN_RESCALE, {&ct1, &ct2}, {&ct1});
+    }
+
+    void CircuitRecorder::multiply_plain_rescale_inplace_internal(CKKSCiphertext &ct, double scalar) {
+        scoped_lock lock(mutex_);
+        record(protobuf::CircuitOp::MULTIPLY_PLAIN_RESCALE_SCALAR, {&ct}, {&ct})->set_scalar(scalar);
+    }
+
+    void CircuitRecorder::multiply_plain_rescale_inplace_internal(CKKSCiphertext &ct, const vector<double> &plain) {
+        scoped_lock lock(mutex_);
+        record(protobuf::CircuitOp::MULTIPLY_PLAIN_RESCALE, {&ct}, {&ct})->set_plaintext(plaintext_index(plain));
+    }
+
+    void CircuitRecorder::inner_product_internal(const vector<CKKSCiphertext> &cts1, const vector<CKKSCiphertext> &cts2,
+                                                 CKKSCiphertext &output) {
+        // the first half of the inputs are `cts1`, and the second half are `cts2`
+        vector<const CKKSCiphertext *> inputs;
+        for (const auto &ct : cts1) {
+            inputs.push_back(&ct);
+        }
+        for (const auto &ct : cts2) {
+            inputs.push_back(&ct);
+        }
+        scoped_lock lock(mutex_);
+        record(protobuf::CircuitOp::INNER_PRODUCT, inputs, {&output});
+    }
+
+    void CircuitRecorder::reduce_level_to_inplace_internal(CKKSCiphertext &ct, int level) {
+        scoped_lock lock(mutex_);
+        record(protobuf::CircuitOp::REDUCE_LEVEL_TO, {&ct}, {&ct})->set_level(level);
+    }
+
+    void CircuitRecorder::rescale_to_next_inplace_internal(CKKSCiphertext &ct) {
+        scoped_lock lock(mutex_);
+        record(protobuf::CircuitOp::RESCALE_TO_NEXT, {&ct}, {&ct});
+    }
+
+    void CircuitRecorder::relinearize_inplace_internal(CKKSCiphertext &ct) {
+        scoped_lock lock(mutex_);
+        record(protobuf::CircuitOp::RELINEARIZE, {&ct}, {&ct});
+    }
+}  // namespace hit
@@ -0,0 +1,122 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <vector>
+
+#include "../ciphertext.h"
+#include "../evaluator.h"
+#include "hit/protobuf/circuit.pb.h"
+
+namespace hit {
+
+    /* This evaluator records a circuit as a dataflow graph, which CircuitReplay can run on another evaluator.
+     * Like OpCount, it only tracks ciphertext metadata. Each operation is recorded with its operands
+     * (including plaintext operands) and the values it produces; each value has a stable ID, which is its
+     * index in the order values were produced. Fused operations (e.g., `multiply_relin_rescale` and
+     * `inner_product`) and `rotate_many` are recorded as single operations, so they are replayed with the
+     * fused implementation of the replaying evaluator.
+     *
+     * A circuit run in parallel (e.g., with LinearAlgebra) is recorded in a nondeterministic order. Any
+     * recorded order is a valid topological order, but to assign the same IDs to the same values each time
+     * the circuit is recorded, use a LinearAlgebra instance with a `max_concurrency` of 1.
+     */
+    class CircuitRecorder : public CKKSEvaluator {
+       public:
+        /* Record a circuit on ciphertexts with `num_slots` slots. `encrypt(coeffs)` produces ciphertexts
+         * at `max_ct_level`, like HomomorphicEval.
+         */
+        CircuitRecorder(int num_slots, int max_ct_level);
+
+        /* For documentation on the API, see ../evaluator.h */
+        ~CircuitRecorder() override = default;
+
+        CircuitRecorder(const CircuitRecorder &) = delete;
+        CircuitRecorder &operator=(const CircuitRecorder &) = delete;
+        CircuitRecorder(CircuitRecorder &&) = delete;
+        CircuitRecorder &operator=(CircuitRecorder &&) = delete;
+
+        /* Each encryption is an input to the circuit; the plaintext is ignored. CircuitReplay::run takes
+         * the inputs in the order they were encrypted.
+         */
+        CKKSCiphertext encrypt(const std::vector<double> &coeffs) override;
+        CKKSCiphertext encrypt(const std::vector<double> &coeffs, int level) override;
+
+        /* Mark `ct` as an output of the circuit. CircuitReplay::run returns the outputs in the order they
+         * were marked. Values which do not contribute to an output are not computed during replay.
+         */
+        void mark_output(const CKKSCiphertext &ct);
+
+        // Serialize the recorded circuit to a protobuf object.
+        // When used directly, you are responsible for calling `delete` on the pointer.
+        protobuf::Circuit *serialize() const;
+        // Serialize the recorded circuit as a protobuf object to a stream.
+        void save(std::ostream &stream) const;
+
+       protected:
+        void rotate_right_inplace_internal(CKKSCiphertext &ct, int steps) override;
+
+        void rotate_left_inplace_internal(CKKSCiphertext &ct, int steps) override;
+
+        void rotate_many_internal(const CKKSCiphertext &ct, const std::vector<int> &steps,
+                                  std::vector<CKKSCiphertext> &outputs) override;
+
+        void negate_inplace_internal(CKKSCiphertext &ct) override;
+
+        void add_inplace_internal(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) override;
+
+        void add_plain_inplace_internal(CKKSCiphertext &ct, double scalar) override;
+
+        void add_plain_inplace_internal(CKKSCiphertext &ct, const std::vector<double> &plain) override;
+
+        void sub_inplace_internal(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) override;
+
+        void sub_plain_inplace_internal(CKKSCiphertext &ct, double scalar) override;
+
+        void sub_plain_inplace_internal(CKKSCiphertext &ct, const std::vector<double> &plain) override;
+
+        void multiply_inplace_internal(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) override;
+
+        void multiply_plain_inplace_internal(CKKSCiphertext &ct, double scalar) override;
+
+        void multiply_plain_inplace_internal(CKKSCiphertext &ct, const std::vector<double> &plain) override;
+
+        void square_inplace_internal(CKKSCiphertext &ct) override;
+
+        void multiply_relin_rescale_inplace_internal(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) override;
+
+        void multiply_plain_rescale_inplace_internal(CKKSCiphertext &ct, double scalar) override;
+
+        void multiply_plain_rescale_inplace_internal(CKKSCiphertext &ct, const std::vector<double> &plain) override;
+
+        void inner_product_internal(const std::vector<CKKSCiphertext> &cts1, const std::vector<CKKSCiphertext> &cts2,
+                                    CKKSCiphertext &output) override;
+
+        void reduce_level_to_inplace_internal(CKKSCiphertext &ct, int level) override;
+
+        void rescale_to_next_inplace_internal(CKKSCiphertext &ct) override;
+
+        void relinearize_inplace_internal(CKKSCiphertext &ct) override;
+
+        int num_slots() const override;
+
+       private:
+        // Record an operation which reads `inputs` and assigns a new value to each of `outputs`, and return it
+        // so that the caller can set its parameters. The caller must hold `mutex_`.
+        protobuf::CircuitOp *record(protobuf::CircuitOp::Type type, const std::vector<const CKKSCiphertext *> &inputs,
+                                    const std::vector<CKKSCiphertext *> &outputs);
+
+        // The index of `plain` in the circuit's plaintexts; identical plaintexts are only stored once.
+        // The caller must hold `mutex_`.
+        uint64_t plaintext_index(const std::vector<double> &plain);
+
+        int num_slots_;
+        int max_ct_level_;
+        protobuf::Circuit circuit_;
+        std::map<std::vector<double>, uint64_t> plaintext_indices_;
+    };
+}  // namespace hit
@@ -125,6 +125,25 @@ namespace hit {
         return destination;
     }
 
+    vector<CKKSCiphertext> DebugEval::encrypt_many(const vector<vector<double>> &coeffs) {
+        return encrypt_many(coeffs, homomorphic_eval->context->max_ciphertext_level());
+    }
+
+    vector<CKKSCiphertext> DebugEval::encrypt_many(const vector<vector<double>> &coeffs, int level) {
+        if (level < 0) {
+            LOG_AND_THROW_STREAM("Explicit encryption level must be non-negative, got " << level);
+        }
+
+        for (const auto &c : coeffs) {
+            scale_estimator->update_plaintext_max_val(c);
+        }
+        vector<CKKSCiphertext> cts = homomorphic_eval->encrypt_many(coeffs, level);
+        for (int i = 0; i < cts.size(); i++) {
+            cts[i].raw_pt = coeffs[i];
+        }
+        return cts;
+    }
+
     vector<double> DebugEval::decrypt(const CKKSCiphertext &encrypted) {
         return decrypt(encrypted, false);
     }
@@ -133,6 +152,11 @@ namespace hit {
         return homomorphic_eval->decrypt(encrypted, suppress_warnings);
     }
 
+    void DebugEval::decrypt_many(const vector<const CKKSCiphertext *> &cts,
+                                 const function<void(int, const vector<double> &)> &consume) {
+        homomorphic_eval->decrypt_many(cts, consume);
+    }
+
     int DebugEval::num_slots() const {
         return homomorphic_eval->num_slots();
     }
@@ -235,6 +259,12 @@ namespace hit {
         scale_estimator->rotate_left_inplace_internal(ct, steps);
     }
 
+    void DebugEval::rotate_many_internal(const CKKSCiphertext &ct, const vector<int> &steps,
+                                         vector<CKKSCiphertext> &outputs) {
+        homomorphic_eval->rotate_many_internal(ct, steps, outputs);
+        scale_estimator->rotate_many_internal(ct, steps, outputs);
+    }
+
     void DebugEval::negate_inplace_internal(CKKSCiphertext &ct) {
         homomorphic_eval->negate_inplace_internal(ct);
         scale_estimator->negate_inplace_internal(ct);
@@ -290,6 +320,27 @@ namespace hit {
         scale_estimator->square_inplace_internal(ct);
     }
 
+    void DebugEval::multiply_relin_rescale_inplace_internal(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) {
+        homomorphic_eval->multiply_relin_rescale_inplace_internal(ct1, ct2);
+        scale_estimator->multiply_relin_rescale_inplace_internal(ct1, ct2);
+    }
+
+    void DebugEval::multiply_plain_rescale_inplace_internal(CKKSCiphertext &ct, double scalar) {
+        homomorphic_eval->multiply_plain_rescale_inplace_internal(ct, scalar);
+        scale_estimator->multiply_plain_rescale_inplace_internal(ct, scalar);
+    }
+
+    void DebugEval::multiply_plain_rescale_inplace_internal(CKKSCiphertext &ct, const vector<double> &plain) {
+        homomorphic_eval->multiply_plain_rescale_inplace_internal(ct, plain);
+        scale_estimator->multiply_plain_rescale_inplace_internal(ct, plain);
+    }
+
+    void DebugEval::inner_product_internal(const vector<CKKSCiphertext> &cts1, const vector<CKKSCiphertext> &cts2,
+                                           CKKSCiphertext &output) {
+        homomorphic_eval->inner_product_internal(cts1, cts2, output);
+        scale_estimator->inner_product_internal(cts1, cts2, output);
+    }
+
     void DebugEval::reduce_level_to_inplace_internal(CKKSCiphertext &ct, int level) {
         homomorphic_eval->reduce_level_to_inplace_internal(ct, level);
         scale_estimator->reduce_level_to_inplace_internal(ct, level);
@@ -45,6 +45,9 @@ namespace hit {
         CKKSCiphertext encrypt(const std::vector<double> &coeffs) override;
         CKKSCiphertext encrypt(const std::vector<double> &coeffs, int level) override;
 
+        std::vector<CKKSCiphertext> encrypt_many(const std::vector<std::vector<double>> &coeffs) override;
+        std::vector<CKKSCiphertext> encrypt_many(const std::vector<std::vector<double>> &coeffs, int level) override;
+
         /* A warning will show in log if you decrypt when the ciphertext is not at level 0
          * Usually, decrypting a ciphertext not at level 0 indicates you are doing something
          * inefficient. However for testing purposes, it may be useful, so you will want to
@@ -53,6 +56,9 @@ namespace hit {
         std::vector<double> decrypt(const CKKSCiphertext &encrypted) override;
         std::vector<double> decrypt(const CKKSCiphertext &encrypted, bool suppress_warnings) override;
 
+        void decrypt_many(const std::vector<const CKKSCiphertext *> &cts,
+                          const std::function<void(int, const std::vector<double> &)> &consume) override;
+
         int num_slots() const override;
 
        protected:
@@ -60,6 +66,9 @@ namespace hit {
 
         void rotate_left_inplace_internal(CKKSCiphertext &ct, int steps) override;
 
+        void rotate_many_internal(const CKKSCiphertext &ct, const std::vector<int> &steps,
+                                  std::vector<CKKSCiphertext> &outputs) override;
+
         void negate_inplace_internal(CKKSCiphertext &ct) override;
 
         void add_inplace_internal(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) override;
@@ -82,6 +91,15 @@ namespace hit {
 
         void square_inplace_internal(CKKSCiphertext &ct) override;
 
+        void multiply_relin_rescale_inplace_internal(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) override;
+
+        void multiply_plain_rescale_inplace_internal(CKKSCiphertext &ct, double scalar) override;
+
+        void multiply_plain_rescale_inplace_internal(CKKSCiphertext &ct, const std::vector<double> &plain) override;
+
+        void inner_product_internal(const std::vector<CKKSCiphertext> &cts1, const std::vector<CKKSCiphertext> &cts2,
+                                    CKKSCiphertext &output) override;
+
         void reduce_level_to_inplace_internal(CKKSCiphertext &ct, int level) override;
 
         void rescale_to_next_inplace_internal(CKKSCiphertext &ct) override;
@@ -9,12 +9,22 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
+#include <atomic>
 #include <iomanip>
+#include <unordered_map>
 
 #include "hit/protobuf/ckksparams.pb.h"
+#include "seal/util/galois.h"
+#include "seal/util/ntt.h"
+#include "seal/util/numth.h"
+#include "seal/util/polyarithsmallmod.h"
+#include "seal/util/rns.h"
+#include "seal/util/uintarithsmallmod.h"
 
 using namespace std;
 using namespace seal;
+using namespace seal::util;
 
 namespace hit {
     /* Note: there is a flag to update_metadata of ciphertexts
@@ -30,7 +40,7 @@ namespace hit {
         timepoint start = chrono::steady_clock::now();
         standard_params_ = params.use_std_params();
         int max_ct_level = params.max_ct_level();
-        context = make_shared<HEContext>(params);
+        context = HEContext::shared(params);
         log_elapsed_time(start, "Creating encryption context...");
         backend_evaluator = new Evaluator(*(context->seal_ctx));
         backend_encoder = new CKKSEncoder(*(context->seal_ctx));
@@ -63,12 +73,15 @@ namespace hit {
         KeyGenerator keygen(*(context->seal_ctx));
         sk = keygen.secret_key();
         keygen.create_public_key(pk);
-        keygen.create_galois_keys(galois_steps, galois_keys);
-        keygen.create_relin_keys(relin_keys);
-
+        keys_ = make_shared<KeyGeneration>();
+        keygen.create_relin_keys(keys_->relin_keys);
         log_elapsed_time(start, "Generating keys...");
 
-        backend_encryptor = new Encryptor(*(context->seal_ctx), pk);
+        start = chrono::steady_clock::now();
+        generate_galois_keys(keygen, galois_steps, keys_->galois_keys);
+        log_elapsed_time(start, "Generating " + to_string(keys_->galois_keys.size()) + " Galois keys...");
+
+        backend_encryptor = new Encryptor(*(context->seal_ctx), pk, sk);
         backend_decryptor = new Decryptor(*(context->seal_ctx), sk);
     }
 
@@ -77,12 +90,42 @@ namespace hit {
         : HomomorphicEval(CKKSParams(num_slots, max_ct_level, log_scale, use_standard_params), galois_steps) {
     }
     HomomorphicEval::~HomomorphicEval() {
+        // stop the background threads, which use the encryptor
+        zero_encryption_pool_.reset();
         delete backend_encoder;
         delete backend_evaluator;
         delete backend_encryptor;
         delete backend_decryptor;
     }
 
+    void HomomorphicEval::generate_galois_keys(KeyGenerator &keygen, const vector<int> &galois_steps,
+                                              GaloisKeys &galois_keys) const {
+        // Invalid steps throw here, before any keys are generated.
+        vector<uint32_t> galois_elts =
+            context->seal_ctx->key_context_data()->galois_tool()->get_elts_from_steps(galois_steps);
+        sort(galois_elts.begin(), galois_elts.end());
+        galois_elts.erase(unique(galois_elts.begin(), galois_elts.end()), galois_elts.end());
+        galois_elts.erase(remove_if(galois_elts.begin(), galois_elts.end(),
+                                    [&](uint32_t galois_elt) { return galois_keys.has_key(galois_elt); }),
+                          galois_elts.end());
+
+        // This mirrors KeyGenerator::create_galois_keys, which stores the key for each Galois element
+        // at GaloisKeys::get_index(elt) of a table with one entry per ring coefficient.
+        galois_keys.data().resize(context->seal_ctx->key_context_data()->parms().poly_modulus_degree());
+        const SecretKey &secret_key = keygen.secret_key();
+        parallel_for(galois_elts.size(), [&](int i) {
+            // SEAL does not document KeyGenerator as thread-safe, so each task uses its own generator for the
+            // same secret key; only the secret key is shared, and it is only read.
+            KeyGenerator task_keygen(*(context->seal_ctx), secret_key);
+            GaloisKeys single_key;
+            task_keygen.create_galois_keys(vector<uint32_t>{galois_elts[i]}, single_key);
+            size_t index = GaloisKeys::get_index(galois_elts[i]);
+            // each task writes a distinct entry of the table
+            galois_keys.data()[index] = move(single_key.data()[index]);
+        });
+        galois_keys.parms_id() = context->seal_ctx->key_parms_id();
+    }
+
     void HomomorphicEval::deserialize_common(istream &params_stream) {
         protobuf::CKKSParams ckks_params;
         ckks_params.ParseFromIstream(&params_stream);
@@ -95,7 +138,7 @@ namespace hit {
 
         standard_params_ = ckks_params.standardparams();
         timepoint start = chrono::steady_clock::now();
-        context = make_shared<HEContext>(CKKSParams(params, log_scale, standard_params_));
+        context = HEContext::shared(CKKSParams(params, log_scale, standard_params_));
         log_elapsed_time(start, "Creating encryption context...");
         backend_evaluator = new Evaluator(*(context->seal_ctx));
         backend_encoder = new CKKSEncoder(*(context->seal_ctx));
@@ -107,11 +150,23 @@ namespace hit {
 
     void HomomorphicEval::deserializeEvalKeys(const timepoint &start, istream &galois_key_stream,
                                               istream &relin_key_stream) {
-        galois_keys.load(*(context->seal_ctx), galois_key_stream);
-        relin_keys.load(*(context->seal_ctx), relin_key_stream);
+        keys_ = make_shared<KeyGeneration>();
+        load_keys(*(context->seal_ctx), galois_key_stream, keys_->galois_keys);
+        load_keys(*(context->seal_ctx), relin_key_stream, keys_->relin_keys);
         log_elapsed_time(start, "Reading keys...");
     }
 
+    shared_ptr<HomomorphicEval::KeyGeneration> HomomorphicEval::load_lazy_keys(const string &galois_key_file,
+                                                                               istream &relin_key_stream) const {
+        auto keys = make_shared<KeyGeneration>();
+        keys->galois_key_file = make_unique<GaloisKeyFile>(galois_key_file);
+        // an empty table, which is populated as keys are needed
+        keys->galois_keys.data().resize(context->seal_ctx->key_context_data()->parms().poly_modulus_degree());
+        keys->galois_keys.parms_id() = context->seal_ctx->key_parms_id();
+        load_keys(*(context->seal_ctx), relin_key_stream, keys->relin_keys);
+        return keys;
+    }
+
     /* An evaluation instance */
     HomomorphicEval::HomomorphicEval(istream &params_stream, istream &galois_key_stream, istream &relin_key_stream) {
         deserialize_common(params_stream);
@@ -119,6 +174,25 @@ namespace hit {
         deserializeEvalKeys(start, galois_key_stream, relin_key_stream);
     }
 
+    /* An evaluation instance with lazily loaded Galois keys */
+    HomomorphicEval::HomomorphicEval(istream &params_stream, const string &galois_key_file, istream &relin_key_stream,
+                                     size_t max_resident_galois_keys)
+        : max_resident_galois_keys_(max_resident_galois_keys) {
+        deserialize_common(params_stream);
+        timepoint start = chrono::steady_clock::now();
+        keys_ = load_lazy_keys(galois_key_file, relin_key_stream);
+        log_elapsed_time(start, "Reading keys...");
+    }
+
+    /* A full instance with lazily loaded Galois keys */
+    HomomorphicEval::HomomorphicEval(istream &params_stream, const string &galois_key_file, istream &relin_key_stream,
+                                     istream &secret_key_stream, size_t max_resident_galois_keys)
+        : HomomorphicEval(params_stream, galois_key_file, relin_key_stream, max_resident_galois_keys) {
+        sk.load(*(context->seal_ctx), secret_key_stream);
+        backend_encryptor->set_secret_key(sk);
+        backend_decryptor = new Decryptor(*(context->seal_ctx), sk);
+    }
+
     /* A full instance */
     HomomorphicEval::HomomorphicEval(istream &params_stream, istream &galois_key_stream, istream &relin_key_stream,
                                      istream &secret_key_stream) {
@@ -126,32 +200,164 @@ namespace hit {
         timepoint start = chrono::steady_clock::now();
         sk.load(*(context->seal_ctx), secret_key_stream);
         deserializeEvalKeys(start, galois_key_stream, relin_key_stream);
+        backend_encryptor->set_secret_key(sk);
         backend_decryptor = new Decryptor(*(context->seal_ctx), sk);
     }
 
-    void HomomorphicEval::save(ostream &params_stream, ostream &galois_key_stream, ostream &relin_key_stream,
-                               ostream *secret_key_stream) {
-        if (secret_key_stream != nullptr) {
-            sk.save(*secret_key_stream);
-        }
-
+    void HomomorphicEval::save_params(const HEContext &context, const PublicKey &pk, bool standard_params,
+                                      ostream &params_stream) {
         protobuf::CKKSParams ckks_params;
         ostringstream sealctxBuf;
-        context->seal_ctx->key_context_data()->parms().save(sealctxBuf);
+        context.seal_ctx->key_context_data()->parms().save(sealctxBuf);
         ckks_params.set_ctx(sealctxBuf.str());
-        ckks_params.set_logscale(context->log_scale());
+        ckks_params.set_logscale(context.log_scale());
 
         ostringstream sealpkBuf;
         pk.save(sealpkBuf);
         ckks_params.set_pubkey(sealpkBuf.str());
 
-        ckks_params.set_standardparams(standard_params_);
+        ckks_params.set_standardparams(standard_params);
         ckks_params.SerializeToOstream(&params_stream);
+    }
+
+    void HomomorphicEval::generate_keys(const CKKSParams &params, const vector<int> &galois_steps,
+                                        ostream &params_stream, const string &galois_key_file,
+                                        ostream &relin_key_stream, ostream &secret_key_stream) {
+        timepoint start = chrono::steady_clock::now();
+        shared_ptr<HEContext> context = HEContext::shared(params);
+        // Invalid steps throw here, before anything is written.
+        vector<uint32_t> galois_elts =
+            context->seal_ctx->key_context_data()->galois_tool()->get_elts_from_steps(galois_steps);
+        sort(galois_elts.begin(), galois_elts.end());
+        galois_elts.erase(unique(galois_elts.begin(), galois_elts.end()), galois_elts.end());
+
+        KeyGenerator keygen(*(context->seal_ctx));
+        keygen.secret_key().save(secret_key_stream);
+        {
+            PublicKey pk;
+            keygen.create_public_key(pk);
+            save_params(*context, pk, params.use_std_params(), params_stream);
+        }
+        {
+            RelinKeys relin_keys;
+            keygen.create_relin_keys(relin_keys);
+            save_key_chunks(relin_keys, relin_key_stream);
+        }
+        log_elapsed_time(start, "Generating keys...");
+
+        start = chrono::steady_clock::now();
+        GaloisKeyFile::write(
+            galois_key_file, galois_elts,
+            [&](uint32_t galois_elt, vector<PublicKey> &storage) -> const vector<PublicKey> & {
+                GaloisKeys single_key;
+                keygen.create_galois_keys(vector<uint32_t>{galois_elt}, single_key);
+                storage = move(single_key.data()[GaloisKeys::get_index(galois_elt)]);
+                return storage;
+            });
+        log_elapsed_time(start, "Generating " + to_string(galois_elts.size()) + " Galois keys...");
+    }
+
+    void HomomorphicEval::save(ostream &params_stream, ostream &galois_key_stream, ostream &relin_key_stream,
+                               ostream *secret_key_stream, bool seeded_keys, bool chunked_keys) {
+        if (seeded_keys && backend_decryptor == nullptr) {
+            LOG_AND_THROW_STREAM("Seeded evaluation keys can only be saved when the secret key is available.");
+        }
+
+        if (secret_key_stream != nullptr) {
+            sk.save(*secret_key_stream);
+        }
+
+        save_params(*context, pk, standard_params_, params_stream);
+
+        shared_ptr<KeyGeneration> keys = current_keys();
+        if (keys->galois_key_file != nullptr) {
+            LOG_AND_THROW_STREAM("Instances which load Galois keys lazily cannot save them; use the key file instead.");
+        }
+
+        // In the chunked formats, each key is compressed separately; see keychunks.h
+        if (seeded_keys) {
+            timepoint start = chrono::steady_clock::now();
+            save_seeded_key_chunks(*(context->seal_ctx), sk, keys->galois_keys, galois_key_stream);
+            save_seeded_key_chunks(*(context->seal_ctx), sk, keys->relin_keys, relin_key_stream);
+            log_elapsed_time(start, "Generating seeded keys...");
+        } else if (chunked_keys) {
+            save_key_chunks(keys->galois_keys, galois_key_stream);
+            save_key_chunks(keys->relin_keys, relin_key_stream);
+        } else {
+            // There is a SEAL limitation that prevents saving large files with compression
+            // This is reported at https://github.com/microsoft/SEAL/issues/142
+            keys->galois_keys.save(galois_key_stream, compr_mode_type::none);
+            keys->relin_keys.save(relin_key_stream);
+        }
+    }
+
+    void HomomorphicEval::save_galois_key_file(const string &path) const {
+        shared_ptr<KeyGeneration> keys = current_keys();
+        if (keys->galois_key_file != nullptr) {
+            LOG_AND_THROW_STREAM("Instances which load Galois keys lazily cannot save them; use the key file instead.");
+        }
+        GaloisKeyFile::write(path, keys->galois_keys);
+    }
 
-        // There is a SEAL limitation that prevents saving large files with compression
-        // This is reported at https://github.com/microsoft/SEAL/issues/142
-        galois_keys.save(galois_key_stream, compr_mode_type::none);
-        relin_keys.save(relin_key_stream);
+    size_t HomomorphicEval::num_resident_galois_keys() const {
+        shared_ptr<KeyGeneration> keys = current_keys();
+        if (keys->galois_key_file == nullptr) {
+            return keys->galois_keys.size();
+        }
+        scoped_lock lock(galois_key_use_mutex_);
+        return keys->galois_key_last_use.size();
+    }
+
+    shared_ptr<HomomorphicEval::KeyGeneration> HomomorphicEval::current_keys() const {
+        shared_lock lock(keys_mutex_);
+        return keys_;
+    }
+
+    void HomomorphicEval::publish_keys(shared_ptr<KeyGeneration> keys) {
+        unique_lock lock(keys_mutex_);
+        keys_.swap(keys);
+        // the previous generation is released here, or by the last operation using it
+    }
+
+    void HomomorphicEval::reload_keys(istream &galois_key_stream, istream &relin_key_stream) {
+        timepoint start = chrono::steady_clock::now();
+        auto keys = make_shared<KeyGeneration>();
+        load_keys(*(context->seal_ctx), galois_key_stream, keys->galois_keys);
+        load_keys(*(context->seal_ctx), relin_key_stream, keys->relin_keys);
+        scoped_lock lock(key_update_mutex_);
+        publish_keys(move(keys));
+        log_elapsed_time(start, "Reloading keys...");
+    }
+
+    void HomomorphicEval::reload_keys(const string &galois_key_file, istream &relin_key_stream) {
+        timepoint start = chrono::steady_clock::now();
+        shared_ptr<KeyGeneration> keys = load_lazy_keys(galois_key_file, relin_key_stream);
+        scoped_lock lock(key_update_mutex_);
+        publish_keys(move(keys));
+        log_elapsed_time(start, "Reloading keys...");
+    }
+
+    void HomomorphicEval::add_galois_steps(const vector<int> &galois_steps) {
+        if (backend_decryptor == nullptr) {
+            LOG_AND_THROW_STREAM("Galois keys can only be generated when the secret key is available.");
+        }
+        // keys added by this call must not be dropped by a concurrent update
+        scoped_lock lock(key_update_mutex_);
+
+        shared_ptr<KeyGeneration> current = current_keys();
+        if (current->galois_key_file != nullptr) {
+            LOG_AND_THROW_STREAM("Galois keys cannot be added to instances which load Galois keys lazily.");
+        }
+        timepoint start = chrono::steady_clock::now();
+        // The current generation may be in use, so the new generation starts from a copy of its keys.
+        auto keys = make_shared<KeyGeneration>();
+        keys->galois_keys = current->galois_keys;
+        keys->relin_keys = current->relin_keys;
+        size_t num_keys = keys->galois_keys.size();
+        KeyGenerator keygen(*(context->seal_ctx), sk);
+        generate_galois_keys(keygen, galois_steps, keys->galois_keys);
+        log_elapsed_time(start, "Generating " + to_string(keys->galois_keys.size() - num_keys) + " Galois keys...");
+        publish_keys(move(keys));
     }
 
     CKKSCiphertext HomomorphicEval::encrypt(const vector<double> &coeffs) {
@@ -169,19 +375,29 @@ namespace hit {
                                  << " coefficients, but " << coeffs.size() << " were provided");
         }
 
-        double scale = pow(2, context->log_scale());
-        // order of operations is very important: floating point arithmetic is not associative
-        for (int i = context->max_ciphertext_level(); i > level; i--) {
-            scale = (scale * scale) / static_cast<double>(context->get_qi(i));
-        }
+        double scale = context->fresh_scale(level);
 
         CKKSCiphertext destination;
         destination.he_level_ = level;
         destination.scale_ = scale;
 
-        Plaintext temp;
-        backend_encoder->encode(coeffs, context->get_context_data(level)->parms_id(), scale, temp);
-        backend_encryptor->encrypt(temp, destination.backend_ct);
+        MemoryPoolHandle pool = memory_pool();
+        Plaintext temp(pool);
+        backend_encoder->encode(coeffs, context->parms_id(level), scale, temp, pool);
+        if (symmetric_encryption_) {
+            // SEAL only produces the seeded form as a Serializable; loading it expands the seed into
+            // a ciphertext which can be evaluated on. The seeded bytes are kept for serialization.
+            stringstream seeded_stream;
+            backend_encryptor->encrypt_symmetric(temp, pool).save(seeded_stream, compr_mode_type::none);
+            destination.backend_ct.load(*(context->seal_ctx), seeded_stream);
+            destination.seeded_ct_ = make_shared<const string>(seeded_stream.str());
+        } else if (zero_encryption_pool_ != nullptr && zero_encryption_pool_->take(level, destination.backend_ct)) {
+            // This is exactly how SEAL encrypts: it adds the plaintext to a fresh encryption of zero
+            destination.backend_ct.scale() = scale;
+            backend_evaluator->add_plain_inplace(destination.backend_ct, temp);
+        } else {
+            backend_encryptor->encrypt(temp, destination.backend_ct, pool);
+        }
 
         destination.num_slots_ = num_slots_;
         destination.initialized = true;
@@ -189,6 +405,31 @@ namespace hit {
         return destination;
     }
 
+    vector<CKKSCiphertext> HomomorphicEval::encrypt_many(const vector<vector<double>> &coeffs) {
+        return encrypt_many(coeffs, context->max_ciphertext_level());
+    }
+
+    vector<CKKSCiphertext> HomomorphicEval::encrypt_many(const vector<vector<double>> &coeffs, int level) {
+        // Validate all inputs up front, before any ciphertexts are encrypted.
+        if (level < 0 || level > context->max_ciphertext_level()) {
+            LOG_AND_THROW_STREAM("Encryption level must be between 0 and " << context->max_ciphertext_level()
+                                                                            << ", got " << level);
+        }
+        for (const auto &c : coeffs) {
+            if (c.size() != num_slots()) {
+                LOG_AND_THROW_STREAM("You can only encrypt vectors which have exactly as many "
+                                     << " coefficients as the number of plaintext slots: Expected " << num_slots()
+                                     << " coefficients, but " << c.size() << " were provided");
+            }
+        }
+
+        // SEAL's encoder and encryptor are safe to use concurrently: all temporary state
+        // lives in memory pool allocations local to each call.
+        vector<CKKSCiphertext> cts(coeffs.size());
+        parallel_for(coeffs.size(), [&](int i) { cts[i] = encrypt(coeffs[i], level); });
+        return cts;
+    }
+
     vector<double> HomomorphicEval::decrypt(const CKKSCiphertext &encrypted) {
         return decrypt(encrypted, false);
     }
@@ -203,27 +444,486 @@ namespace hit {
             decryption_warning(encrypted.he_level());
         }
 
-        Plaintext temp;
+        MemoryPoolHandle pool = memory_pool();
+        Plaintext temp(pool);
         backend_decryptor->decrypt(encrypted.backend_ct, temp);
         vector<double> decoded_output;
-        backend_encoder->decode(temp, decoded_output);
+        backend_encoder->decode(temp, decoded_output, pool);
         return decoded_output;
     }
 
+    void HomomorphicEval::decrypt_many(const vector<const CKKSCiphertext *> &cts,
+                                       const function<void(int, const vector<double> &)> &consume) {
+        // check this before decrypting anything
+        if (backend_decryptor == nullptr) {
+            LOG_AND_THROW_STREAM(
+                "Decryption is only possible from a deserialized instance when the secret key is provided.");
+        }
+
+        parallel_for(cts.size(), [&](int i) {
+            MemoryPoolHandle pool = memory_pool();
+            Plaintext temp(pool);
+            backend_decryptor->decrypt(cts[i]->backend_ct, temp);
+            vector<double> decoded_output;
+            backend_encoder->decode(temp, decoded_output, pool);
+            consume(i, decoded_output);
+        });
+    }
+
     int HomomorphicEval::num_slots() const {
         return context->num_slots();
     }
 
+    void HomomorphicEval::set_plaintext_cache_limit(size_t max_bytes) {
+        plaintext_cache_.set_max_bytes(max_bytes);
+    }
+
+    PlaintextCacheStats HomomorphicEval::plaintext_cache_stats() const {
+        return plaintext_cache_.stats();
+    }
+
+    void HomomorphicEval::clear_plaintext_cache() {
+        plaintext_cache_.clear();
+    }
+
+    void HomomorphicEval::set_fast_level_reduction(bool enabled) {
+        fast_level_reduction_ = enabled;
+    }
+
+    void HomomorphicEval::set_thread_local_memory_pools(bool enabled) {
+        thread_local_pools_ = enabled;
+    }
+
+    vector<MemoryPoolStats> HomomorphicEval::memory_pool_stats() const {
+        vector<MemoryPoolStats> stats;
+        stats.push_back(MemoryPoolStats{thread::id(), MemoryManager::GetPool().alloc_byte_count()});
+        scoped_lock lock(thread_pools_->mutex);
+        for (const auto &[thread_id, pool] : thread_pools_->pools) {
+            stats.push_back(MemoryPoolStats{thread_id, pool.alloc_byte_count()});
+        }
+        return stats;
+    }
+
+    void HomomorphicEval::enable_zero_encryption_pool(const ZeroEncryptionPoolConfig &config) {
+        // stop the existing pool (if any) before starting a new one
+        zero_encryption_pool_.reset();
+        zero_encryption_pool_ = make_unique<ZeroEncryptionPool>(
+            config, context->max_ciphertext_level(), [this](int level, Ciphertext &ct) {
+                backend_encryptor->encrypt_zero(context->parms_id(level), ct);
+            });
+    }
+
+    void HomomorphicEval::disable_zero_encryption_pool() {
+        zero_encryption_pool_.reset();
+    }
+
+    void HomomorphicEval::fill_zero_encryption_pool() {
+        if (zero_encryption_pool_ != nullptr) {
+            zero_encryption_pool_->fill();
+        }
+    }
+
+    ZeroEncryptionPoolStats HomomorphicEval::zero_encryption_pool_stats() const {
+        if (zero_encryption_pool_ == nullptr) {
+            return ZeroEncryptionPoolStats();
+        }
+        return zero_encryption_pool_->stats();
+    }
+
+    void HomomorphicEval::set_symmetric_encryption(bool enabled) {
+        if (enabled && backend_decryptor == nullptr) {
+            LOG_AND_THROW_STREAM("Symmetric encryption is only possible when the secret key is available.");
+        }
+        symmetric_encryption_ = enabled;
+    }
+
+    /* The evaluators whose registries hold the calling thread's pool. When the thread exits, its pool is
+     * removed from every registry which still exists; the registries are held weakly, so an evaluator may
+     * be destroyed before the threads which used it.
+     */
+    class HomomorphicEval::ThreadPoolRegistrations {
+       public:
+        ThreadPoolRegistrations() = default;
+        ThreadPoolRegistrations(const ThreadPoolRegistrations &) = delete;
+        ThreadPoolRegistrations &operator=(const ThreadPoolRegistrations &) = delete;
+
+        ~ThreadPoolRegistrations() {
+            for (const auto &[registry_id, weak_registry] : registries_) {
+                shared_ptr<ThreadPoolRegistry> registry = weak_registry.lock();
+                if (registry) {
+                    scoped_lock lock(registry->mutex);
+                    registry->pools.erase(this_thread::get_id());
+                }
+            }
+        }
+
+        void add(uint64_t registry_id, const shared_ptr<ThreadPoolRegistry> &registry, const MemoryPoolHandle &pool) {
+            if (registries_.find(registry_id) != registries_.end()) {
+                return;
+            }
+            // forget evaluators which have been destroyed, so that this set does not grow without bound
+            for (auto it = registries_.begin(); it != registries_.end();) {
+                it = it->second.expired() ? registries_.erase(it) : next(it);
+            }
+            registries_[registry_id] = registry;
+            scoped_lock lock(registry->mutex);
+            registry->pools[this_thread::get_id()] = pool;
+        }
+
+       private:
+        unordered_map<uint64_t, weak_ptr<ThreadPoolRegistry>> registries_;
+    };
+
+    uint64_t HomomorphicEval::next_pool_registry_id() {
+        static atomic<uint64_t> next_id{0};
+        return next_id++;
+    }
+
+    MemoryPoolHandle HomomorphicEval::memory_pool() {
+        if (!thread_local_pools_) {
+            return MemoryManager::GetPool();
+        }
+        MemoryPoolHandle pool = MemoryManager::GetPool(mm_prof_opt::mm_force_thread_local);
+        // Register this thread's pool with the evaluator the first time the thread uses it.
+        // The registry is only locked once per (thread, evaluator) pair.
+        thread_local ThreadPoolRegistrations registrations;
+        registrations.add(pool_registry_id_, thread_pools_, pool);
+        return pool;
+    }
+
+    int HomomorphicEval::backend_level(const CKKSCiphertext &ct) const {
+        return static_cast<int>(context->seal_ctx->get_context_data(ct.backend_ct.parms_id())->chain_index());
+    }
+
+    void HomomorphicEval::check_rescale_level(const CKKSCiphertext &ct) const {
+        if (backend_level(ct) == 0) {
+            LOG_AND_THROW_STREAM("Cannot rescale a level 0 ciphertext.");
+        }
+    }
+
+    shared_ptr<const Plaintext> HomomorphicEval::encode_cached(const vector<double> &plain, const CKKSCiphertext &ct) {
+        const parms_id_type &parms_id = ct.backend_ct.parms_id();
+        shared_ptr<const Plaintext> cached = plaintext_cache_.lookup(plain, parms_id, ct.scale());
+        if (cached != nullptr) {
+            return cached;
+        }
+        // cached plaintexts outlive this call (and may be used by other threads), so they are allocated
+        // from the global pool, but the encoder's temporaries are not
+        auto encoded = make_shared<Plaintext>();
+        backend_encoder->encode(plain, parms_id, ct.scale(), *encoded, memory_pool());
+        plaintext_cache_.insert(plain, parms_id, ct.scale(), encoded);
+        return encoded;
+    }
+
     uint64_t HomomorphicEval::get_last_prime_internal(const CKKSCiphertext &ct) const {
         return context->get_qi(ct.he_level());
     }
 
     void HomomorphicEval::rotate_right_inplace_internal(CKKSCiphertext &ct, int steps) {
-        backend_evaluator->rotate_vector_inplace(ct.backend_ct, -steps, galois_keys);
+        rotate_inplace(ct, -steps);
     }
 
     void HomomorphicEval::rotate_left_inplace_internal(CKKSCiphertext &ct, int steps) {
-        backend_evaluator->rotate_vector_inplace(ct.backend_ct, steps, galois_keys);
+        rotate_inplace(ct, steps);
+    }
+
+    void HomomorphicEval::set_rotation_plan(const RotationKeyPlan &plan) {
+        rotation_decompositions_ = plan.decompositions;
+    }
+
+    vector<int> HomomorphicEval::key_steps_for_step(int step) const {
+        auto decomposition = rotation_decompositions_.find(step);
+        if (decomposition == rotation_decompositions_.end()) {
+            return {step};
+        }
+        return decomposition->second;
+    }
+
+    void HomomorphicEval::rotate_inplace(CKKSCiphertext &ct, int step) {
+        vector<int> key_steps = key_steps_for_step(step);
+        with_galois_keys(key_steps, [&](const KeyGeneration &keys) {
+            for (int key_step : key_steps) {
+                backend_evaluator->rotate_vector_inplace(ct.backend_ct, key_step, keys.galois_keys, memory_pool());
+            }
+        });
+    }
+
+    void HomomorphicEval::rotate_many_internal(const CKKSCiphertext &ct, const vector<int> &steps,
+                                               vector<CKKSCiphertext> &outputs) {
+        vector<int> key_steps;
+        for (int step : steps) {
+            vector<int> step_keys = key_steps_for_step(step);
+            key_steps.insert(key_steps.end(), step_keys.begin(), step_keys.end());
+        }
+        with_galois_keys(key_steps, [&](const KeyGeneration &keys) { hoisted_rotate_many(keys, ct, steps, outputs); });
+    }
+
+    vector<uint32_t> HomomorphicEval::galois_elts_for_step(const KeyGeneration &keys, int step) const {
+        if (step == 0) {
+            return {};
+        }
+        const GaloisTool *galois_tool = context->seal_ctx->key_context_data()->galois_tool();
+        uint32_t galois_elt = galois_tool->get_elt_from_step(step);
+        if (has_galois_key(keys, galois_elt)) {
+            return {galois_elt};
+        }
+        // Without a key for this step, SEAL composes the rotation from the steps in the non-adjacent form
+        vector<uint32_t> galois_elts;
+        for (int naf_step : naf(step)) {
+            galois_elts.push_back(galois_tool->get_elt_from_step(naf_step));
+        }
+        return galois_elts;
+    }
+
+    bool HomomorphicEval::has_galois_key(const KeyGeneration &keys, uint32_t galois_elt) {
+        if (keys.galois_key_file != nullptr) {
+            return keys.galois_key_file->contains(galois_elt);
+        }
+        return keys.galois_keys.has_key(galois_elt);
+    }
+
+    void HomomorphicEval::with_galois_keys(const vector<int> &steps,
+                                           const function<void(const KeyGeneration &)> &body) {
+        // This reference keeps the generation alive until `body` is done, even if the keys are replaced.
+        shared_ptr<KeyGeneration> keys = current_keys();
+        if (keys->galois_key_file == nullptr) {
+            body(*keys);
+            return;
+        }
+
+        vector<uint32_t> galois_elts;
+        for (int step : steps) {
+            for (uint32_t galois_elt : galois_elts_for_step(*keys, step)) {
+                galois_elts.push_back(galois_elt);
+            }
+        }
+        sort(galois_elts.begin(), galois_elts.end());
+        galois_elts.erase(unique(galois_elts.begin(), galois_elts.end()), galois_elts.end());
+
+        // Pin the keys so that no other thread evicts them before `body` is done with them
+        vector<uint32_t> missing;
+        {
+            scoped_lock lock(galois_key_use_mutex_);
+            for (uint32_t galois_elt : galois_elts) {
+                keys->galois_key_pins[galois_elt]++;
+                // keys which are not in the file are left for SEAL to report
+                if (keys->galois_key_last_use.count(galois_elt) == 0 && keys->galois_key_file->contains(galois_elt)) {
+                    missing.push_back(galois_elt);
+                }
+            }
+        }
+
+        try {
+            if (!missing.empty()) {
+                // Read the keys without holding a lock, so that rotations with resident keys can proceed.
+                // Another thread may load the same key concurrently; only one copy is kept.
+                vector<vector<PublicKey>> loaded(missing.size());
+                for (int i = 0; i < missing.size(); i++) {
+                    keys->galois_key_file->load(*(context->seal_ctx), missing[i], loaded[i]);
+                }
+                unique_lock table_lock(keys->galois_keys_mutex);
+                scoped_lock lock(galois_key_use_mutex_);
+                for (int i = 0; i < missing.size(); i++) {
+                    if (keys->galois_key_last_use.count(missing[i]) == 0) {
+                        keys->galois_keys.data()[GaloisKeys::get_index(missing[i])] = move(loaded[i]);
+                        keys->galois_key_last_use[missing[i]] = galois_key_clock_;
+                    }
+                }
+                evict_galois_keys(*keys);
+            }
+
+            shared_lock table_lock(keys->galois_keys_mutex);
+            {
+                scoped_lock lock(galois_key_use_mutex_);
+                galois_key_clock_++;
+                for (uint32_t galois_elt : galois_elts) {
+                    if (keys->galois_key_last_use.count(galois_elt) > 0) {
+                        keys->galois_key_last_use[galois_elt] = galois_key_clock_;
+                    }
+                }
+            }
+            body(*keys);
+        } catch (...) {
+            unpin_galois_keys(*keys, galois_elts);
+            throw;
+        }
+        unpin_galois_keys(*keys, galois_elts);
+    }
+
+    void HomomorphicEval::evict_galois_keys(KeyGeneration &keys) {
+        if (max_resident_galois_keys_ == 0) {
+            return;
+        }
+        while (keys.galois_key_last_use.size() > max_resident_galois_keys_) {
+            auto victim = keys.galois_key_last_use.end();
+            for (auto it = keys.galois_key_last_use.begin(); it != keys.galois_key_last_use.end(); it++) {
+                if (keys.galois_key_pins.count(it->first) == 0 &&
+                    (victim == keys.galois_key_last_use.end() || it->second < victim->second)) {
+                    victim = it;
+                }
+            }
+            if (victim == keys.galois_key_last_use.end()) {
+                // every resident key is in use
+                return;
+            }
+            keys.galois_keys.data()[GaloisKeys::get_index(victim->first)].clear();
+            keys.galois_key_last_use.erase(victim);
+        }
+    }
+
+    void HomomorphicEval::unpin_galois_keys(KeyGeneration &keys, const vector<uint32_t> &galois_elts) {
+        scoped_lock lock(galois_key_use_mutex_);
+        for (uint32_t galois_elt : galois_elts) {
+            if (--keys.galois_key_pins[galois_elt] == 0) {
+                keys.galois_key_pins.erase(galois_elt);
+            }
+        }
+    }
+
+    /* SEAL's key switching (used for every rotation) starts by decomposing the second ciphertext
+     * component c_1: it is converted to coefficient form, and the residue of c_1 modulo each
+     * ciphertext prime q_j is lifted to every prime of the key modulus and converted back to NTT form.
+     * This accounts for most of the cost of a rotation. Since a Galois automorphism commutes with
+     * the decomposition (the automorphism of a digit is a valid digit of the automorphism), we
+     * compute the decomposition once, and then apply each automorphism directly to the digits
+     * ("hoisting"; see Halevi-Shoup'18). The automorphism is a permutation in NTT form.
+     *
+     * The decomposition is stored as (L+1)*L polynomials, where L is the number of ciphertext primes.
+     * Digit (i,j) is c_1 mod q_j, represented modulo the i^th key prime (i=L is the special prime).
+     */
+    void HomomorphicEval::hoisted_rotate_many(const KeyGeneration &keys, const CKKSCiphertext &ct,
+                                              const vector<int> &steps, vector<CKKSCiphertext> &outputs) {
+        const Ciphertext &input = ct.backend_ct;
+        auto context_data = context->seal_ctx->get_context_data(input.parms_id());
+        const GaloisTool *galois_tool = context_data->galois_tool();
+
+        vector<int> hoisted_idxs;
+        for (int i = 0; i < steps.size(); i++) {
+            if (steps[i] == 0) {
+                // outputs[i] is already a copy of the input
+                continue;
+            }
+            if (rotation_decompositions_.count(steps[i]) > 0) {
+                // a planned composition of several key rotations
+                for (int key_step : rotation_decompositions_.at(steps[i])) {
+                    backend_evaluator->rotate_vector_inplace(outputs[i].backend_ct, key_step, keys.galois_keys,
+                                                             memory_pool());
+                }
+            } else if (has_galois_key(keys, galois_tool->get_elt_from_step(steps[i]))) {
+                hoisted_idxs.push_back(i);
+            } else {
+                // SEAL composes this rotation from several keys, so it can't use the shared decomposition
+                backend_evaluator->rotate_vector_inplace(outputs[i].backend_ct, steps[i], keys.galois_keys,
+                                                         memory_pool());
+            }
+        }
+        if (hoisted_idxs.empty()) {
+            return;
+        }
+
+        auto key_context_data = context->seal_ctx->key_context_data();
+        const auto &key_modulus = key_context_data->parms().coeff_modulus();
+        const NTTTables *key_ntt_tables = key_context_data->small_ntt_tables();
+        size_t coeff_count = context_data->parms().poly_modulus_degree();
+        size_t decomp_modulus_size = context_data->parms().coeff_modulus().size();
+        size_t rns_modulus_size = decomp_modulus_size + 1;
+
+        // c_1 in coefficient form
+        vector<uint64_t> c1_coeffs(input.data(1), input.data(1) + decomp_modulus_size * coeff_count);
+        for (size_t j = 0; j < decomp_modulus_size; j++) {
+            inverse_ntt_negacyclic_harvey(c1_coeffs.data() + j * coeff_count, key_ntt_tables[j]);
+        }
+
+        vector<uint64_t> digits(rns_modulus_size * decomp_modulus_size * coeff_count);
+        for (size_t i = 0; i < rns_modulus_size; i++) {
+            size_t key_index = (i == decomp_modulus_size ? key_modulus.size() - 1 : i);
+            for (size_t j = 0; j < decomp_modulus_size; j++) {
+                uint64_t *digit = digits.data() + (i * decomp_modulus_size + j) * coeff_count;
+                if (i == j) {
+                    // the input is already in NTT form modulo q_j
+                    copy_n(input.data(1) + j * coeff_count, coeff_count, digit);
+                } else {
+                    modulo_poly_coeffs(c1_coeffs.data() + j * coeff_count, coeff_count, key_modulus[key_index],
+                                       digit);
+                    ntt_negacyclic_harvey(digit, key_ntt_tables[key_index]);
+                }
+            }
+        }
+
+        for (int idx : hoisted_idxs) {
+            hoisted_rotation(keys.galois_keys, input, digits, galois_tool->get_elt_from_step(steps[idx]),
+                             outputs[idx].backend_ct);
+        }
+    }
+
+    // This follows Evaluator::apply_galois_inplace and Evaluator::switch_key_inplace in SEAL,
+    // except that the automorphism is applied to the decomposed digits of c_1.
+    void HomomorphicEval::hoisted_rotation(const GaloisKeys &galois_keys, const Ciphertext &input,
+                                           const vector<uint64_t> &digits, uint32_t galois_elt,
+                                           Ciphertext &output) const {
+        auto context_data = context->seal_ctx->get_context_data(input.parms_id());
+        const GaloisTool *galois_tool = context_data->galois_tool();
+        auto key_context_data = context->seal_ctx->key_context_data();
+        const auto &key_modulus = key_context_data->parms().coeff_modulus();
+        const NTTTables *key_ntt_tables = key_context_data->small_ntt_tables();
+        const MultiplyUIntModOperand *modswitch_factors = key_context_data->rns_tool()->inv_q_last_mod_q();
+        size_t coeff_count = context_data->parms().poly_modulus_degree();
+        size_t decomp_modulus_size = context_data->parms().coeff_modulus().size();
+        size_t rns_modulus_size = decomp_modulus_size + 1;
+        size_t special_index = key_modulus.size() - 1;
+        const vector<PublicKey> &key_vector = galois_keys.data()[GaloisKeys::get_index(galois_elt)];
+
+        // inner product of the rotated digits with the key, for each of the two key components
+        vector<uint64_t> products(2 * rns_modulus_size * coeff_count, 0);
+        vector<uint64_t> rotated_digit(coeff_count);
+        vector<uint64_t> temp(coeff_count);
+        for (size_t i = 0; i < rns_modulus_size; i++) {
+            size_t key_index = (i == decomp_modulus_size ? special_index : i);
+            for (size_t j = 0; j < decomp_modulus_size; j++) {
+                galois_tool->apply_galois_ntt(digits.data() + (i * decomp_modulus_size + j) * coeff_count, galois_elt,
+                                              rotated_digit.data());
+                for (size_t k = 0; k < 2; k++) {
+                    uint64_t *product = products.data() + (k * rns_modulus_size + i) * coeff_count;
+                    dyadic_product_coeffmod(rotated_digit.data(), key_vector[j].data().data(k) + key_index * coeff_count,
+                                            coeff_count, key_modulus[key_index], temp.data());
+                    add_poly_coeffmod(product, temp.data(), coeff_count, key_modulus[key_index], product);
+                }
+            }
+        }
+
+        // The first output component is the automorphism of c_0 plus the first key-switched component
+        for (size_t j = 0; j < decomp_modulus_size; j++) {
+            galois_tool->apply_galois_ntt(input.data(0) + j * coeff_count, galois_elt,
+                                          output.data(0) + j * coeff_count);
+        }
+
+        // Divide by the special prime (with rounding) to switch back to the ciphertext modulus
+        uint64_t qk_half = key_modulus[special_index].value() >> 1;
+        vector<uint64_t> t_last(coeff_count);
+        for (size_t k = 0; k < 2; k++) {
+            const uint64_t *product = products.data() + k * rns_modulus_size * coeff_count;
+            copy_n(product + decomp_modulus_size * coeff_count, coeff_count, t_last.data());
+            inverse_ntt_negacyclic_harvey(t_last.data(), key_ntt_tables[special_index]);
+            // add (p-1)/2 to change from flooring to rounding
+            add_poly_scalar_coeffmod(t_last.data(), coeff_count, qk_half, key_modulus[special_index], t_last.data());
+
+            for (size_t j = 0; j < decomp_modulus_size; j++) {
+                const Modulus &qi = key_modulus[j];
+                modulo_poly_coeffs(t_last.data(), coeff_count, qi, temp.data());
+                sub_poly_scalar_coeffmod(temp.data(), coeff_count, barrett_reduce_64(qk_half, qi), qi, temp.data());
+                ntt_negacyclic_harvey(temp.data(), key_ntt_tables[j]);
+                // (ct mod q_j - ct mod p) * p^{-1} mod q_j
+                sub_poly_coeffmod(product + j * coeff_count, temp.data(), coeff_count, qi, temp.data());
+                multiply_poly_scalar_coeffmod(temp.data(), coeff_count, modswitch_factors[j], qi, temp.data());
+
+                uint64_t *destination = output.data(k) + j * coeff_count;
+                if (k == 0) {
+                    add_poly_coeffmod(destination, temp.data(), coeff_count, qi, destination);
+                } else {
+                    copy_n(temp.data(), coeff_count, destination);
+                }
+            }
+        }
     }
 
     void HomomorphicEval::negate_inplace_internal(CKKSCiphertext &ct) {
@@ -235,15 +935,14 @@ namespace hit {
     }
 
     void HomomorphicEval::add_plain_inplace_internal(CKKSCiphertext &ct, double scalar) {
-        Plaintext encoded_plain;
-        backend_encoder->encode(scalar, ct.backend_ct.parms_id(), ct.scale(), encoded_plain);
+        MemoryPoolHandle pool = memory_pool();
+        Plaintext encoded_plain(pool);
+        backend_encoder->encode(scalar, ct.backend_ct.parms_id(), ct.scale(), encoded_plain, pool);
         backend_evaluator->add_plain_inplace(ct.backend_ct, encoded_plain);
     }
 
     void HomomorphicEval::add_plain_inplace_internal(CKKSCiphertext &ct, const vector<double> &plain) {
-        Plaintext temp;
-        backend_encoder->encode(plain, ct.backend_ct.parms_id(), ct.scale(), temp);
-        backend_evaluator->add_plain_inplace(ct.backend_ct, temp);
+        backend_evaluator->add_plain_inplace(ct.backend_ct, *encode_cached(plain, ct));
     }
 
     void HomomorphicEval::sub_inplace_internal(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) {
@@ -251,29 +950,29 @@ namespace hit {
     }
 
     void HomomorphicEval::sub_plain_inplace_internal(CKKSCiphertext &ct, double scalar) {
-        Plaintext encoded_plain;
-        backend_encoder->encode(scalar, ct.backend_ct.parms_id(), ct.scale(), encoded_plain);
+        MemoryPoolHandle pool = memory_pool();
+        Plaintext encoded_plain(pool);
+        backend_encoder->encode(scalar, ct.backend_ct.parms_id(), ct.scale(), encoded_plain, pool);
         backend_evaluator->sub_plain_inplace(ct.backend_ct, encoded_plain);
     }
 
     void HomomorphicEval::sub_plain_inplace_internal(CKKSCiphertext &ct, const vector<double> &plain) {
-        Plaintext temp;
-        backend_encoder->encode(plain, ct.backend_ct.parms_id(), ct.scale(), temp);
-        backend_evaluator->sub_plain_inplace(ct.backend_ct, temp);
+        backend_evaluator->sub_plain_inplace(ct.backend_ct, *encode_cached(plain, ct));
     }
 
     void HomomorphicEval::multiply_inplace_internal(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) {
-        backend_evaluator->multiply_inplace(ct1.backend_ct, ct2.backend_ct);
+        backend_evaluator->multiply_inplace(ct1.backend_ct, ct2.backend_ct, memory_pool());
     }
 
     void HomomorphicEval::multiply_plain_inplace_internal(CKKSCiphertext &ct, double scalar) {
+        MemoryPoolHandle pool = memory_pool();
         if (scalar != double{0}) {
-            Plaintext encoded_plain;
-            backend_encoder->encode(scalar, ct.backend_ct.parms_id(), ct.scale(), encoded_plain);
-            backend_evaluator->multiply_plain_inplace(ct.backend_ct, encoded_plain);
+            Plaintext encoded_plain(pool);
+            backend_encoder->encode(scalar, ct.backend_ct.parms_id(), ct.scale(), encoded_plain, pool);
+            backend_evaluator->multiply_plain_inplace(ct.backend_ct, encoded_plain, pool);
         } else {
             double previous_scale = ct.scale();
-            backend_encryptor->encrypt_zero(ct.backend_ct.parms_id(), ct.backend_ct);
+            backend_encryptor->encrypt_zero(ct.backend_ct.parms_id(), ct.backend_ct, pool);
             // seal sets the scale to be 1, but our the debug evaluator always ensures that the SEAL scale is
             // consistent with our mirror calculation
             ct.backend_ct.scale() = previous_scale * previous_scale;
@@ -281,27 +980,95 @@ namespace hit {
     }
 
     void HomomorphicEval::multiply_plain_inplace_internal(CKKSCiphertext &ct, const vector<double> &plain) {
-        Plaintext temp;
-        backend_encoder->encode(plain, ct.backend_ct.parms_id(), ct.scale(), temp);
-        backend_evaluator->multiply_plain_inplace(ct.backend_ct, temp);
+        backend_evaluator->multiply_plain_inplace(ct.backend_ct, *encode_cached(plain, ct), memory_pool());
     }
 
     void HomomorphicEval::square_inplace_internal(CKKSCiphertext &ct) {
-        backend_evaluator->square_inplace(ct.backend_ct);
+        backend_evaluator->square_inplace(ct.backend_ct, memory_pool());
+    }
+
+    // Chain SEAL's in-place operations directly on the backend ciphertext, so that
+    // the quadratic intermediate is never copied or exposed through the HIT API.
+    void HomomorphicEval::multiply_relin_rescale_inplace_internal(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) {
+        check_rescale_level(ct1);
+        MemoryPoolHandle pool = memory_pool();
+        backend_evaluator->multiply_inplace(ct1.backend_ct, ct2.backend_ct, pool);
+        backend_evaluator->relinearize_inplace(ct1.backend_ct, current_keys()->relin_keys, pool);
+        backend_evaluator->rescale_to_next_inplace(ct1.backend_ct, pool);
+    }
+
+    void HomomorphicEval::multiply_plain_rescale_inplace_internal(CKKSCiphertext &ct, double scalar) {
+        check_rescale_level(ct);
+        multiply_plain_inplace_internal(ct, scalar);
+        backend_evaluator->rescale_to_next_inplace(ct.backend_ct, memory_pool());
+    }
+
+    void HomomorphicEval::multiply_plain_rescale_inplace_internal(CKKSCiphertext &ct, const vector<double> &plain) {
+        check_rescale_level(ct);
+        MemoryPoolHandle pool = memory_pool();
+        backend_evaluator->multiply_plain_inplace(ct.backend_ct, *encode_cached(plain, ct), pool);
+        backend_evaluator->rescale_to_next_inplace(ct.backend_ct, pool);
+    }
+
+    // SEAL can add quadratic ciphertexts, so we accumulate the products before
+    // performing a single relinearization (key switch) and rescale.
+    void HomomorphicEval::inner_product_internal(const vector<CKKSCiphertext> &cts1,
+                                                 const vector<CKKSCiphertext> &cts2, CKKSCiphertext &output) {
+        check_rescale_level(output);
+        MemoryPoolHandle pool = memory_pool();
+        backend_evaluator->multiply_inplace(output.backend_ct, cts2[0].backend_ct, pool);
+        Ciphertext prod(pool);
+        for (int i = 1; i < cts1.size(); i++) {
+            backend_evaluator->multiply(cts1[i].backend_ct, cts2[i].backend_ct, prod, pool);
+            backend_evaluator->add_inplace(output.backend_ct, prod);
+        }
+        backend_evaluator->relinearize_inplace(output.backend_ct, current_keys()->relin_keys, pool);
+        backend_evaluator->rescale_to_next_inplace(output.backend_ct, pool);
     }
 
     void HomomorphicEval::reduce_level_to_inplace_internal(CKKSCiphertext &ct, int level) {
-        while (ct.he_level() > level) {
-            multiply_plain_inplace(ct, 1);
-            rescale_to_next_inplace(ct);
+        int input_level = backend_level(ct);
+        if (input_level <= level) {
+            return;
+        }
+
+        MemoryPoolHandle pool = memory_pool();
+        if (!fast_level_reduction_) {
+            for (int i = input_level; i > level; i--) {
+                Plaintext encoded_one(pool);
+                backend_encoder->encode(1.0, ct.backend_ct.parms_id(), ct.backend_ct.scale(), encoded_one, pool);
+                backend_evaluator->multiply_plain_inplace(ct.backend_ct, encoded_one, pool);
+                backend_evaluator->rescale_to_next_inplace(ct.backend_ct, pool);
+            }
+            return;
         }
+
+        // This is the nominal scale at the target level; it matches the computation
+        // in CKKSEvaluator::reduce_metadata_to_level.
+        double target_scale = ct.backend_ct.scale();
+        for (int i = input_level; i > level; i--) {
+            target_scale = (target_scale * target_scale) / static_cast<double>(context->get_qi(i));
+        }
+
+        // Dropping primes does not change the scale of the ciphertext, so drop all but one of them,
+        // then multiply by 1 at whatever scale results in exactly `target_scale` after the last rescale.
+        uint64_t last_prime = context->get_qi(level + 1);
+        backend_evaluator->mod_switch_to_inplace(ct.backend_ct, context->parms_id(level + 1), pool);
+        double plain_scale = target_scale * static_cast<double>(last_prime) / ct.backend_ct.scale();
+        Plaintext encoded_one(pool);
+        backend_encoder->encode(1.0, ct.backend_ct.parms_id(), plain_scale, encoded_one, pool);
+        backend_evaluator->multiply_plain_inplace(ct.backend_ct, encoded_one, pool);
+        backend_evaluator->rescale_to_next_inplace(ct.backend_ct, pool);
+        // The product and quotient above are subject to floating point rounding;
+        // the true scale of the plaintext is within an ulp of the target scale.
+        ct.backend_ct.scale() = target_scale;
     }
 
     void HomomorphicEval::rescale_to_next_inplace_internal(CKKSCiphertext &ct) {
-        backend_evaluator->rescale_to_next_inplace(ct.backend_ct);
+        backend_evaluator->rescale_to_next_inplace(ct.backend_ct, memory_pool());
     }
 
     void HomomorphicEval::relinearize_inplace_internal(CKKSCiphertext &ct) {
-        backend_evaluator->relinearize_inplace(ct.backend_ct, relin_keys);
+        backend_evaluator->relinearize_inplace(ct.backend_ct, current_keys()->relin_keys, memory_pool());
     }
 }  // namespace hit
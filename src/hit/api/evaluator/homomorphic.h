@@ -3,13 +3,33 @@
 
 #pragma once
 
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+
 #include "../../common.h"
 #include "../ciphertext.h"
 #include "../evaluator.h"
+#include "../galoiskeyfile.h"
+#include "../keychunks.h"
 #include "../params.h"
+#include "../plaintextcache.h"
+#include "../rotationplan.h"
+#include "../zeroencryptionpool.h"
 
 namespace hit {
 
+    struct MemoryPoolStats {
+        // The thread which allocates from this pool, or a default-constructed id for SEAL's global pool
+        std::thread::id thread_id;
+        // The number of bytes currently allocated by the pool
+        size_t alloc_bytes;
+    };
+
     /* This evaluator is a thin wrapper around
      * SEAL's evaluator API. It actually does
      * computation on SEAL ciphertexts.
@@ -38,6 +58,30 @@ namespace hit {
         HomomorphicEval(std::istream &params_stream, std::istream &galois_key_stream, std::istream &relin_key_stream,
                         std::istream &secret_key_stream);
 
+        /* An evaluation-only instance whose Galois keys are loaded lazily from a key file written by
+         * `save_galois_key_file`. The file is memory-mapped, and each rotation key is loaded the first time
+         * a rotation needs it, so startup time and memory usage are proportional to the rotations used.
+         * If `max_resident_galois_keys` is positive, the least-recently used keys are evicted to keep
+         * at most that many keys in memory (keys in use by an ongoing rotation are never evicted).
+         */
+        HomomorphicEval(std::istream &params_stream, const std::string &galois_key_file,
+                        std::istream &relin_key_stream, size_t max_resident_galois_keys = 0);
+
+        /* A full instance whose Galois keys are loaded lazily, as above. */
+        HomomorphicEval(std::istream &params_stream, const std::string &galois_key_file,
+                        std::istream &relin_key_stream, std::istream &secret_key_stream,
+                        size_t max_resident_galois_keys = 0);
+
+        /* Generate keys for `params` and `galois_steps` without constructing an instance, writing the Galois
+         * keys to a key file as each one is generated. Each key is freed once it is written, so peak memory
+         * is bounded by a single key-switching key (plus the public and secret keys), rather than by the
+         * total size reported by `estimate_key_size`. Keys are generated sequentially to keep this bound.
+         * The output can be loaded by the lazy constructors above.
+         */
+        static void generate_keys(const CKKSParams &params, const std::vector<int> &galois_steps,
+                                  std::ostream &params_stream, const std::string &galois_key_file,
+                                  std::ostream &relin_key_stream, std::ostream &secret_key_stream);
+
         /* For documentation on the API, see ../evaluator.h */
         ~HomomorphicEval() override;
 
@@ -47,12 +91,51 @@ namespace hit {
         HomomorphicEval &operator=(HomomorphicEval &&) = delete;
 
         // set secret_key_stream to nullptr to serialize an evaluation-only instance
+        // By default, evaluation keys are serialized directly by SEAL, so they can be loaded with
+        // `seal::GaloisKeys::load` and `seal::RelinKeys::load`. If `chunked_keys` is true, they are written in a
+        // compressed, chunked format instead (see ../keychunks.h), which is smaller and faster to save and load,
+        // but can only be read by HIT. The constructors above accept both formats.
+        // If `seeded_keys` is true, freshly generated evaluation keys are written in seeded form, which is
+        // roughly half the size. This requires the secret key, and is slower since the keys are regenerated.
+        // Seeded keys are always written in the chunked format.
         void save(std::ostream &params_stream, std::ostream &galois_key_stream, std::ostream &relin_key_stream,
-                  std::ostream *secret_key_stream);
+                  std::ostream *secret_key_stream, bool seeded_keys = false, bool chunked_keys = false);
+
+        // Write the Galois keys to an indexed key file, which can be loaded lazily by the constructor above.
+        // This is not available for instances which load their Galois keys lazily.
+        void save_galois_key_file(const std::string &path) const;
+
+        // The number of Galois keys currently in memory
+        size_t num_resident_galois_keys() const;
+
+        /* Atomically replace the evaluation keys, for example when a client rotates its keys. Keys are read in
+         * any format accepted by the constructors. Operations already in progress finish with the keys they
+         * started with, which are freed once the last such operation completes; operations which start after
+         * this call use the new keys. The first form loads all Galois keys, and the second loads them lazily
+         * from a key file, as in the constructor above. The public and secret keys are not changed.
+         */
+        void reload_keys(std::istream &galois_key_stream, std::istream &relin_key_stream);
+        void reload_keys(const std::string &galois_key_file, std::istream &relin_key_stream);
+
+        /* Generate Galois keys for additional rotation steps (e.g., steps discovered by a RotationSet evaluator),
+         * and atomically add them to the current keys. Steps which already have keys are ignored.
+         * This requires the secret key, and is not available for instances which load Galois keys lazily.
+         */
+        void add_galois_steps(const std::vector<int> &galois_steps);
+
+        /* Compose rotations by steps without their own key as described by `plan.decompositions`, rather than
+         * with SEAL's default decomposition into powers of two. The instance should have keys for `plan.key_steps`.
+         * This setting should not be changed while the evaluator is in use by another thread.
+         */
+        void set_rotation_plan(const RotationKeyPlan &plan);
 
         CKKSCiphertext encrypt(const std::vector<double> &coeffs) override;
         CKKSCiphertext encrypt(const std::vector<double> &coeffs, int level) override;
 
+        // Encode and encrypt the vectors in parallel.
+        std::vector<CKKSCiphertext> encrypt_many(const std::vector<std::vector<double>> &coeffs) override;
+        std::vector<CKKSCiphertext> encrypt_many(const std::vector<std::vector<double>> &coeffs, int level) override;
+
         /* A warning will show in log if you decrypt when the ciphertext is not at level 0
          * Usually, decrypting a ciphertext not at level 0 indicates you are doing something
          * inefficient. However you may want to suppress the warning for testing either by
@@ -61,15 +144,81 @@ namespace hit {
         std::vector<double> decrypt(const CKKSCiphertext &encrypted) override;
         std::vector<double> decrypt(const CKKSCiphertext &encrypted, bool suppress_warnings) override;
 
+        // Decrypt and decode the ciphertexts in parallel.
+        void decrypt_many(const std::vector<const CKKSCiphertext *> &cts,
+                          const std::function<void(int, const std::vector<double> &)> &consume) override;
+
         std::shared_ptr<HEContext> context;
 
         int num_slots() const override;
 
+        /* Public plaintext vectors passed to add_plain, sub_plain, and multiply_plain are
+         * encoded once per (plaintext, level, scale) and cached, so that repeatedly applying the same
+         * mask (as LinearAlgebra does) only pays for a single encoding. The cache is bounded by
+         * `max_bytes`, and evicts the least-recently used plaintexts first. A limit of 0 disables the cache.
+         */
+        void set_plaintext_cache_limit(size_t max_bytes);
+
+        // Hit/miss counters and memory usage of the plaintext cache
+        PlaintextCacheStats plaintext_cache_stats() const;
+
+        void clear_plaintext_cache();
+
+        /* By default, reduce_level_to drops all but one of the primes with a (nearly free) modulus switch,
+         * and then performs a single multiplication by 1 and a rescale to land exactly on the nominal scale
+         * of the target level. This costs one plaintext multiplication and one rescale no matter how many
+         * levels are dropped. Disabling the fast path restores the original behavior of a multiplication
+         * and a rescale for every level. Both approaches produce ciphertexts with identical metadata.
+         * This setting should not be changed while the evaluator is in use by another thread.
+         */
+        void set_fast_level_reduction(bool enabled);
+
+        /* By default, SEAL allocates all temporary memory from its global memory pool. When many threads evaluate
+         * concurrently (e.g., in LinearAlgebra), they all contend on that pool's lock. When thread-local pools are
+         * enabled, every SEAL call made by this evaluator allocates temporaries from a pool owned by the calling
+         * thread. Long-lived objects (cached plaintexts) and decryption, which uses its own pool, are unaffected.
+         * Memory in a thread-local pool is only released when the thread exits. This setting should not be changed
+         * while the evaluator is in use by another thread.
+         */
+        void set_thread_local_memory_pools(bool enabled);
+
+        // The global pool, followed by every thread-local pool which has been used by this evaluator
+        std::vector<MemoryPoolStats> memory_pool_stats() const;
+
+        /* Split public-key encryption into an offline and an online phase. Background threads precompute
+         * fresh encryptions of zero for the configured levels; `encrypt` then only encodes the message and
+         * adds it to a precomputed encryption of zero. When no precomputed encryption is available for the
+         * requested level, `encrypt` falls back to encrypting inline. Enabling the pool replaces any existing pool.
+         * These functions should not be called while the evaluator is in use by another thread.
+         */
+        void enable_zero_encryption_pool(const ZeroEncryptionPoolConfig &config = ZeroEncryptionPoolConfig());
+
+        // Stops the background threads and discards all precomputed encryptions.
+        void disable_zero_encryption_pool();
+
+        // Block until the zero encryption pool is full. Does nothing if the pool is disabled.
+        void fill_zero_encryption_pool();
+
+        // Returns default (empty) statistics if the pool is disabled.
+        ZeroEncryptionPoolStats zero_encryption_pool_stats() const;
+
+        /* Instances which hold the secret key can encrypt with it instead of the public key. Secret-key
+         * encryption is cheaper, and half of each fresh ciphertext is generated from a small random seed.
+         * Until a ciphertext is modified by an evaluator, `CKKSCiphertext::serialize` emits this seeded form,
+         * which is roughly half the size of a full ciphertext. Secret-key encryption does not use the zero
+         * encryption pool. Throws if the secret key is not available. This setting should not be changed
+         * while the evaluator is in use by another thread.
+         */
+        void set_symmetric_encryption(bool enabled);
+
        protected:
         void rotate_right_inplace_internal(CKKSCiphertext &ct, int steps) override;
 
         void rotate_left_inplace_internal(CKKSCiphertext &ct, int steps) override;
 
+        void rotate_many_internal(const CKKSCiphertext &ct, const std::vector<int> &steps,
+                                  std::vector<CKKSCiphertext> &outputs) override;
+
         void negate_inplace_internal(CKKSCiphertext &ct) override;
 
         void add_inplace_internal(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) override;
@@ -92,6 +241,15 @@ namespace hit {
 
         void square_inplace_internal(CKKSCiphertext &ct) override;
 
+        void multiply_relin_rescale_inplace_internal(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) override;
+
+        void multiply_plain_rescale_inplace_internal(CKKSCiphertext &ct, double scalar) override;
+
+        void multiply_plain_rescale_inplace_internal(CKKSCiphertext &ct, const std::vector<double> &plain) override;
+
+        void inner_product_internal(const std::vector<CKKSCiphertext> &cts1, const std::vector<CKKSCiphertext> &cts2,
+                                    CKKSCiphertext &output) override;
+
         void reduce_level_to_inplace_internal(CKKSCiphertext &ct, int level) override;
 
         void rescale_to_next_inplace_internal(CKKSCiphertext &ct) override;
@@ -105,16 +263,118 @@ namespace hit {
         seal::Decryptor *backend_decryptor = nullptr;  // no default constructor
         seal::PublicKey pk;
         seal::SecretKey sk;
-        seal::GaloisKeys galois_keys;
-        seal::RelinKeys relin_keys;
         bool standard_params_;
+        PlaintextCache plaintext_cache_;
+        bool fast_level_reduction_ = true;
+        std::atomic<bool> thread_local_pools_{false};
+        bool symmetric_encryption_ = false;
+        std::map<int, std::vector<int>> rotation_decompositions_;
+        // Thread-local pools used by this evaluator, for memory_pool_stats. A thread's pool is registered
+        // the first time the thread calls memory_pool(), which is tracked by `pool_registry_id_`, and is
+        // deregistered when the thread exits, so that the pool can be released.
+        struct ThreadPoolRegistry {
+            std::unordered_map<std::thread::id, seal::MemoryPoolHandle> pools;
+            std::mutex mutex;
+        };
+        const std::shared_ptr<ThreadPoolRegistry> thread_pools_ = std::make_shared<ThreadPoolRegistry>();
+        const uint64_t pool_registry_id_ = next_pool_registry_id();
+        class ThreadPoolRegistrations;
+
+        static uint64_t next_pool_registry_id();
+
+        std::unique_ptr<ZeroEncryptionPool> zero_encryption_pool_;
+
+        /* A generation of evaluation keys. Generations are immutable once published, except for the table of
+         * resident Galois keys in lazy mode: when `galois_key_file` is set, `galois_keys` holds only the
+         * resident keys. Rotations hold a shared lock on the table, while loading and evicting keys requires
+         * an exclusive lock.
+         */
+        struct KeyGeneration {
+            seal::GaloisKeys galois_keys;
+            seal::RelinKeys relin_keys;
+            std::unique_ptr<GaloisKeyFile> galois_key_file;
+            std::shared_mutex galois_keys_mutex;
+            // Guarded by `galois_key_use_mutex_`. Keys pinned by an ongoing rotation are never evicted.
+            std::unordered_map<uint32_t, uint64_t> galois_key_last_use;
+            std::unordered_map<uint32_t, int> galois_key_pins;
+        };
+
+        // The current keys. Each operation holds a reference to the generation it started with, so
+        // replacing the keys only requires an exclusive lock on `keys_mutex_` while the pointer is swapped.
+        std::shared_ptr<KeyGeneration> keys_;
+        mutable std::shared_mutex keys_mutex_;
+        // Serializes updates to the keys, so that concurrent updates are not lost
+        std::mutex key_update_mutex_;
+        size_t max_resident_galois_keys_ = 0;
+        mutable std::mutex galois_key_use_mutex_;
+        uint64_t galois_key_clock_ = 0;
+
+        std::shared_ptr<KeyGeneration> current_keys() const;
+
+        void publish_keys(std::shared_ptr<KeyGeneration> keys);
+
+        // The key steps used to rotate by `step`, according to the rotation plan
+        std::vector<int> key_steps_for_step(int step) const;
+
+        // Rotate by `step` (left rotations are positive), composing the rotation according to the rotation plan
+        void rotate_inplace(CKKSCiphertext &ct, int step);
+
+        // Run `body`, which rotates by each of `steps`, with the Galois keys it needs resident.
+        void with_galois_keys(const std::vector<int> &steps, const std::function<void(const KeyGeneration &)> &body);
+
+        // The Galois elements whose keys SEAL uses to rotate by `step`
+        std::vector<uint32_t> galois_elts_for_step(const KeyGeneration &keys, int step) const;
+
+        static bool has_galois_key(const KeyGeneration &keys, uint32_t galois_elt);
+
+        // Evict least-recently used, unpinned keys. Requires the table lock and `galois_key_use_mutex_`.
+        void evict_galois_keys(KeyGeneration &keys);
+
+        void unpin_galois_keys(KeyGeneration &keys, const std::vector<uint32_t> &galois_elts);
+
+        // The memory pool for temporary allocations in SEAL calls made by the current thread
+        seal::MemoryPoolHandle memory_pool();
+
+        // Encode `plain` at the level and scale of `ct`, using the plaintext cache when possible.
+        std::shared_ptr<const seal::Plaintext> encode_cached(const std::vector<double> &plain,
+                                                             const CKKSCiphertext &ct);
 
         uint64_t get_last_prime_internal(const CKKSCiphertext &ct) const override;
+
+        // The implementation of rotate_many_internal, which requires the Galois keys to be resident
+        void hoisted_rotate_many(const KeyGeneration &keys, const CKKSCiphertext &ct, const std::vector<int> &steps,
+                                 std::vector<CKKSCiphertext> &outputs);
+
+        // Apply the Galois automorphism `galois_elt` to `input`, writing the result to `output`.
+        // `digits` is the key-switching decomposition of the second component of `input`,
+        // as computed by rotate_many_internal.
+        void hoisted_rotation(const seal::GaloisKeys &galois_keys, const seal::Ciphertext &input,
+                              const std::vector<uint64_t> &digits, uint32_t galois_elt,
+                              seal::Ciphertext &output) const;
+
+        // The level of the SEAL ciphertext, which may not match the HIT metadata
+        int backend_level(const CKKSCiphertext &ct) const;
+
+        // Throw an exception if `ct` is at level 0. The fused operations call this before modifying their
+        // input, since SEAL only detects this when it rescales the product.
+        void check_rescale_level(const CKKSCiphertext &ct) const;
+
+        // Generate the Galois keys for `galois_steps` which are not already in `galois_keys` in parallel,
+        // one Galois element per task, and add them to `galois_keys`.
+        void generate_galois_keys(seal::KeyGenerator &keygen, const std::vector<int> &galois_steps,
+                                  seal::GaloisKeys &galois_keys) const;
+
         void deserializeEvalKeys(const timepoint &start, std::istream &galois_key_stream,
                                  std::istream &relin_key_stream);
 
+        std::shared_ptr<KeyGeneration> load_lazy_keys(const std::string &galois_key_file,
+                                                      std::istream &relin_key_stream) const;
+
         void deserialize_common(std::istream &params_stream);
 
+        static void save_params(const HEContext &context, const seal::PublicKey &pk, bool standard_params,
+                                std::ostream &params_stream);
+
         friend class DebugEval;
         friend class ScaleEstimator;
     };
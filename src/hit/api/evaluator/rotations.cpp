@@ -38,13 +38,23 @@ namespace hit {
         return vector<int>(rotations.begin(), rotations.end());
     }
 
-    void RotationSet::rotate_right_inplace_internal(CKKSCiphertext &, int k) {
+    vector<RotationCount> RotationSet::rotation_counts() const {
+        vector<RotationCount> result;
+        for (const auto &entry : rotation_counts_) {
+            result.push_back(RotationCount{entry.first.first, entry.first.second, entry.second});
+        }
+        return result;
+    }
+
+    void RotationSet::rotate_right_inplace_internal(CKKSCiphertext &ct, int k) {
         scoped_lock lock(mutex_);
         rotations.insert(-k);
+        rotation_counts_[make_pair(-k, ct.he_level())]++;
     }
 
-    void RotationSet::rotate_left_inplace_internal(CKKSCiphertext &, int k) {
+    void RotationSet::rotate_left_inplace_internal(CKKSCiphertext &ct, int k) {
         scoped_lock lock(mutex_);
         rotations.insert(k);
+        rotation_counts_[make_pair(k, ct.he_level())]++;
     }
 }  // namespace hit
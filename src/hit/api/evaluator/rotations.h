@@ -3,18 +3,22 @@
 
 #pragma once
 
+#include <map>
 #include <set>
+#include <utility>
 #include <vector>
 
 #include "../ciphertext.h"
 #include "../evaluator.h"
+#include "../rotationplan.h"
 
 namespace hit {
 
     /* This evaluator tracks the plaintext computation to determine the set of explicit
      * rotations performed by the circuit. The output of `needed_rotations` is a vector
      * suitable for the `galois_steps` argument of the HomomorphicEvaluator or DebugEvaluator
-     * constructors
+     * constructors. If keys for every rotation use too much memory, `rotation_counts` can be
+     * passed to `plan_rotation_keys` to choose a smaller set of keys.
      */
     class RotationSet : public CKKSEvaluator {
        public:
@@ -31,6 +35,9 @@ namespace hit {
         /* Return the total number of operations performed in this computation. */
         std::vector<int> needed_rotations() const;
 
+        /* The number of rotations by each step at each ciphertext level. */
+        std::vector<RotationCount> rotation_counts() const;
+
         CKKSCiphertext encrypt(const std::vector<double> &coeffs) override;
         CKKSCiphertext encrypt(const std::vector<double> &coeffs, int level) override;
 
@@ -43,6 +50,8 @@ namespace hit {
 
        private:
         std::set<int> rotations;
+        // keyed by (step, level)
+        std::map<std::pair<int, int>, uint64_t> rotation_counts_;
         int num_slots_;
     };
 }  // namespace hit
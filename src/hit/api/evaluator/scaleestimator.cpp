@@ -22,7 +22,7 @@ namespace hit {
         plaintext_eval = new PlaintextEval(num_slots);
 
         CKKSParams params(num_slots, multiplicative_depth, default_scale_bits, false);
-        context = make_shared<HEContext>(params);
+        context = HEContext::shared(params);
     }
 
     ScaleEstimator::ScaleEstimator(int num_slots, const HomomorphicEval &homom_eval) {
@@ -58,15 +58,9 @@ namespace hit {
             level = context->max_ciphertext_level();
         }
 
-        double scale = pow(2, context->log_scale());
-        // order of operations is very important: floating point arithmetic is not associative
-        for (int i = context->max_ciphertext_level(); i > level; i--) {
-            scale = (scale * scale) / static_cast<double>(context->get_qi(i));
-        }
-
         CKKSCiphertext destination;
         destination.he_level_ = level;
-        destination.scale_ = scale;
+        destination.scale_ = context->fresh_scale(level);
         destination.raw_pt = coeffs;
         destination.num_slots_ = context->num_slots();
         destination.initialized = true;
@@ -96,10 +90,7 @@ namespace hit {
     // print some debug info
     void ScaleEstimator::print_stats(const CKKSCiphertext &ct) {
         double exact_plaintext_max_val = l_inf_norm(ct.raw_pt);
-        double log_modulus = 0;
-        for (int i = 0; i <= ct.he_level(); i++) {
-            log_modulus += log2(context->get_qi(i));
-        }
+        double log_modulus = context->log_modulus(ct.he_level());
         plaintext_eval->print_stats(ct);
         VLOG(VLOG_EVAL) << "    + Level: " << ct.he_level();
         VLOG(VLOG_EVAL) << "    + Plaintext logmax: " << log2(exact_plaintext_max_val)
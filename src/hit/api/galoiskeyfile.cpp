@@ -0,0 +1,166 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "galoiskeyfile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <fstream>
+
+#include "../common.h"
+
+using namespace std;
+using namespace seal;
+
+namespace hit {
+
+    namespace {
+        const char MAGIC[8] = {'H', 'I', 'T', 'G', 'K', 'E', 'Y', '1'};
+        const size_t HEADER_SIZE = sizeof(MAGIC) + sizeof(uint64_t);
+        const size_t INDEX_ENTRY_SIZE = 3 * sizeof(uint64_t);
+
+        void write_u64(ostream &out, uint64_t value) {
+            out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+        }
+
+        uint64_t read_u64(const seal_byte *in) {
+            uint64_t value;
+            memcpy(&value, in, sizeof(value));
+            return value;
+        }
+    }  // namespace
+
+    void GaloisKeyFile::write(const string &path, const GaloisKeys &keys) {
+        vector<uint32_t> galois_elts;
+        for (size_t i = 0; i < keys.data().size(); i++) {
+            if (!keys.data()[i].empty()) {
+                // inverse of GaloisKeys::get_index
+                galois_elts.push_back(static_cast<uint32_t>(2 * i + 1));
+            }
+        }
+        // the keys are written directly from `keys`, without copying them
+        write(path, galois_elts, [&](uint32_t galois_elt, vector<PublicKey> &) -> const vector<PublicKey> & {
+            return keys.key(galois_elt);
+        });
+    }
+
+    void GaloisKeyFile::write(const string &path, const vector<uint32_t> &galois_elts,
+                              const function<const vector<PublicKey> &(uint32_t, vector<PublicKey> &)> &get_key) {
+        ofstream out(path, ios::binary | ios::trunc);
+        if (!out) {
+            LOG_AND_THROW_STREAM("Unable to open Galois key file " << path << " for writing");
+        }
+
+        out.write(MAGIC, sizeof(MAGIC));
+        write_u64(out, galois_elts.size());
+        streampos index_pos = out.tellp();
+        // reserve space for the index, which is written once the record offsets are known
+        vector<uint64_t> index(3 * galois_elts.size(), 0);
+        out.write(reinterpret_cast<const char *>(index.data()), index.size() * sizeof(uint64_t));
+
+        for (size_t i = 0; i < galois_elts.size(); i++) {
+            streampos record_start = out.tellp();
+            vector<PublicKey> storage;
+            const vector<PublicKey> &key = get_key(galois_elts[i], storage);
+            write_u64(out, key.size());
+            for (const auto &k : key) {
+                k.save(out, compr_mode_type::none);
+            }
+            index[3 * i] = galois_elts[i];
+            index[3 * i + 1] = static_cast<uint64_t>(record_start);
+            index[3 * i + 2] = static_cast<uint64_t>(out.tellp() - record_start);
+        }
+
+        out.seekp(index_pos);
+        out.write(reinterpret_cast<const char *>(index.data()), index.size() * sizeof(uint64_t));
+        if (!out) {
+            LOG_AND_THROW_STREAM("Error writing Galois key file " << path);
+        }
+    }
+
+    GaloisKeyFile::GaloisKeyFile(const string &path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            LOG_AND_THROW_STREAM("Unable to open Galois key file " << path);
+        }
+        struct stat file_stat {};
+        if (fstat(fd, &file_stat) != 0 || static_cast<size_t>(file_stat.st_size) < HEADER_SIZE) {
+            close(fd);
+            LOG_AND_THROW_STREAM("Invalid Galois key file " << path << ": file is too small");
+        }
+        size_ = file_stat.st_size;
+        void *mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        // the mapping remains valid after the file is closed
+        close(fd);
+        if (mapping == MAP_FAILED) {
+            LOG_AND_THROW_STREAM("Unable to memory-map Galois key file " << path);
+        }
+        data_ = static_cast<const seal_byte *>(mapping);
+
+        if (memcmp(data_, MAGIC, sizeof(MAGIC)) != 0) {
+            munmap(mapping, size_);
+            LOG_AND_THROW_STREAM("Invalid Galois key file " << path << ": bad header");
+        }
+        uint64_t num_records = read_u64(data_ + sizeof(MAGIC));
+        if (num_records > (size_ - HEADER_SIZE) / INDEX_ENTRY_SIZE) {
+            munmap(mapping, size_);
+            LOG_AND_THROW_STREAM("Invalid Galois key file " << path << ": index is truncated");
+        }
+        for (uint64_t i = 0; i < num_records; i++) {
+            const seal_byte *entry = data_ + HEADER_SIZE + i * INDEX_ENTRY_SIZE;
+            uint64_t galois_elt = read_u64(entry);
+            Record record{read_u64(entry + sizeof(uint64_t)), read_u64(entry + 2 * sizeof(uint64_t))};
+            if (record.offset > size_ || record.size > size_ - record.offset || record.size < sizeof(uint64_t)) {
+                munmap(mapping, size_);
+                LOG_AND_THROW_STREAM("Invalid Galois key file " << path << ": record " << i << " is out of bounds");
+            }
+            index_[static_cast<uint32_t>(galois_elt)] = record;
+        }
+    }
+
+    GaloisKeyFile::~GaloisKeyFile() {
+        munmap(const_cast<seal_byte *>(data_), size_);
+    }
+
+    bool GaloisKeyFile::contains(uint32_t galois_elt) const {
+        return index_.find(galois_elt) != index_.end();
+    }
+
+    vector<uint32_t> GaloisKeyFile::galois_elts() const {
+        vector<uint32_t> result;
+        result.reserve(index_.size());
+        for (const auto &entry : index_) {
+            result.push_back(entry.first);
+        }
+        return result;
+    }
+
+    void GaloisKeyFile::load(const SEALContext &context, uint32_t galois_elt, vector<PublicKey> &key) const {
+        auto it = index_.find(galois_elt);
+        if (it == index_.end()) {
+            LOG_AND_THROW_STREAM("The Galois key file does not contain a key for Galois element " << galois_elt);
+        }
+        const seal_byte *record = data_ + it->second.offset;
+        size_t remaining = it->second.size - sizeof(uint64_t);
+        uint64_t num_keys = read_u64(record);
+        // there is exactly one key-switching key per ciphertext prime (every prime but the special prime); key
+        // switching reads the key for each prime, so a record with fewer keys cannot be used
+        if (num_keys != context.key_context_data()->parms().coeff_modulus().size() - 1) {
+            LOG_AND_THROW_STREAM("Invalid Galois key file: record for Galois element "
+                                 << galois_elt << " contains " << num_keys << " keys");
+        }
+        record += sizeof(uint64_t);
+
+        key.clear();
+        key.resize(num_keys);
+        for (auto &k : key) {
+            auto bytes_read = static_cast<size_t>(k.load(context, record, remaining));
+            record += bytes_read;
+            remaining -= bytes_read;
+        }
+    }
+}  // namespace hit
@@ -0,0 +1,68 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "seal/seal.h"
+
+namespace hit {
+
+    /* An internal API for the HE backend.
+     * An indexed container for Galois keys, with one record per Galois element, so that individual
+     * keys can be loaded without reading the entire key set. The file is memory-mapped, and records
+     * are only read (and paged in) when they are loaded.
+     *
+     * The format is an 8-byte magic string, the number of records, and an index of
+     * (Galois element, offset, size) triples, followed by the records. Each record is the number of
+     * key-switching keys for the element, followed by the uncompressed SEAL serialization of each key.
+     * All integers are 64 bits, in native byte order.
+     */
+    class GaloisKeyFile {
+       public:
+        // Write all keys in `keys` to the file at `path`, overwriting it if it exists.
+        static void write(const std::string &path, const seal::GaloisKeys &keys);
+
+        /* Write a key for each element of `galois_elts` to the file at `path`, overwriting it if it exists.
+         * `get_key(galois_elt, storage)` returns the key for each element: either a reference to an existing
+         * key, or `storage` after producing the key in it. Each key is written, and `storage` is freed, before
+         * the next key is requested, so only one produced key is in memory at a time.
+         */
+        static void write(const std::string &path, const std::vector<uint32_t> &galois_elts,
+                          const std::function<const std::vector<seal::PublicKey> &(
+                              uint32_t, std::vector<seal::PublicKey> &)> &get_key);
+
+        // Memory-map an existing key file.
+        explicit GaloisKeyFile(const std::string &path);
+
+        ~GaloisKeyFile();
+
+        GaloisKeyFile(const GaloisKeyFile &) = delete;
+        GaloisKeyFile &operator=(const GaloisKeyFile &) = delete;
+        GaloisKeyFile(GaloisKeyFile &&) = delete;
+        GaloisKeyFile &operator=(GaloisKeyFile &&) = delete;
+
+        bool contains(uint32_t galois_elt) const;
+
+        std::vector<uint32_t> galois_elts() const;
+
+        // Deserialize the keys for `galois_elt`, in the format of an entry of `seal::GaloisKeys::data()`.
+        // This function is safe to call concurrently.
+        void load(const seal::SEALContext &context, uint32_t galois_elt, std::vector<seal::PublicKey> &key) const;
+
+       private:
+        struct Record {
+            uint64_t offset;
+            uint64_t size;
+        };
+
+        std::unordered_map<uint32_t, Record> index_;
+        const seal::seal_byte *data_ = nullptr;
+        size_t size_ = 0;
+    };
+}  // namespace hit
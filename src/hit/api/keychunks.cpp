@@ -0,0 +1,230 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "keychunks.h"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../common.h"
+#include "seal/valcheck.h"
+
+using namespace std;
+using namespace seal;
+
+namespace hit {
+
+    namespace {
+        const char MAGIC[8] = {'H', 'I', 'T', 'K', 'C', 'H', 'K', '1'};
+        const char SEEDED_MAGIC[8] = {'H', 'I', 'T', 'K', 'S', 'E', 'D', '1'};
+
+        void write_u64(ostream &out, uint64_t value) {
+            out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+        }
+
+        uint64_t read_u64(istream &in) {
+            uint64_t value = 0;
+            in.read(reinterpret_cast<char *>(&value), sizeof(value));
+            if (!in) {
+                LOG_AND_THROW_STREAM("Error loading keys: unexpected end of stream");
+            }
+            return value;
+        }
+
+        // the most memory allocated for a chunk before the data already allocated has been read
+        const uint64_t MAX_READ_SIZE = 1 << 20;
+
+        // Read a chunk of `size` bytes. Memory is allocated as the data arrives, so a corrupt size in the index
+        // fails as a truncated stream, rather than with an allocation of up to 2^64 bytes.
+        void read_chunk(istream &in, uint64_t size, string &chunk) {
+            chunk.clear();
+            while (chunk.size() < size) {
+                size_t offset = chunk.size();
+                auto piece_size = static_cast<size_t>(min(size - offset, MAX_READ_SIZE));
+                chunk.resize(offset + piece_size);
+                in.read(&chunk[offset], static_cast<streamsize>(piece_size));
+                if (!in) {
+                    LOG_AND_THROW_STREAM("Error loading keys: unexpected end of stream");
+                }
+            }
+        }
+
+        // Returns the magic string of a chunked key set, or nullptr if the stream does not start with one.
+        // The stream position is not changed.
+        const char *peek_magic(istream &stream) {
+            char magic[sizeof(MAGIC)];
+            streampos start = stream.tellg();
+            stream.read(magic, sizeof(magic));
+            bool complete = stream.gcount() == sizeof(magic);
+            stream.clear();
+            stream.seekg(start);
+            if (complete && memcmp(magic, MAGIC, sizeof(MAGIC)) == 0) {
+                return MAGIC;
+            }
+            if (complete && memcmp(magic, SEEDED_MAGIC, sizeof(SEEDED_MAGIC)) == 0) {
+                return SEEDED_MAGIC;
+            }
+            return nullptr;
+        }
+
+        void write_chunks(const char *magic, size_t table_size, const vector<uint64_t> &table_idxs,
+                          const vector<string> &chunks, ostream &stream) {
+            stream.write(magic, sizeof(MAGIC));
+            write_u64(stream, table_size);
+            write_u64(stream, chunks.size());
+            for (size_t i = 0; i < chunks.size(); i++) {
+                write_u64(stream, table_idxs[i]);
+                write_u64(stream, chunks[i].size());
+            }
+            for (const auto &chunk : chunks) {
+                stream.write(chunk.data(), static_cast<streamsize>(chunk.size()));
+            }
+        }
+
+        vector<uint64_t> nonempty_table_idxs(const KSwitchKeys &keys) {
+            vector<uint64_t> table_idxs;
+            for (size_t i = 0; i < keys.data().size(); i++) {
+                if (!keys.data()[i].empty()) {
+                    table_idxs.push_back(i);
+                }
+            }
+            return table_idxs;
+        }
+    }  // namespace
+
+    void save_key_chunks(const KSwitchKeys &keys, ostream &stream) {
+        vector<uint64_t> table_idxs = nonempty_table_idxs(keys);
+
+        // Compression dominates the cost of serialization, so chunks are compressed in parallel
+        vector<string> chunks(table_idxs.size());
+        parallel_for(table_idxs.size(), [&](int i) {
+            const vector<PublicKey> &key = keys.data()[table_idxs[i]];
+            ostringstream chunk;
+            write_u64(chunk, key.size());
+            for (const auto &k : key) {
+                k.save(chunk, Serialization::compr_mode_default);
+            }
+            chunks[i] = chunk.str();
+        });
+
+        write_chunks(MAGIC, keys.data().size(), table_idxs, chunks, stream);
+    }
+
+    void save_seeded_key_chunks(const SEALContext &context, const SecretKey &secret_key, const GaloisKeys &keys,
+                                ostream &stream) {
+        vector<uint64_t> table_idxs = nonempty_table_idxs(keys);
+        vector<string> chunks(table_idxs.size());
+        parallel_for(table_idxs.size(), [&](int i) {
+            // inverse of GaloisKeys::get_index
+            auto galois_elt = static_cast<uint32_t>(2 * table_idxs[i] + 1);
+            KeyGenerator keygen(context, secret_key);
+            ostringstream chunk;
+            keygen.create_galois_keys(vector<uint32_t>{galois_elt}).save(chunk, Serialization::compr_mode_default);
+            chunks[i] = chunk.str();
+        });
+        write_chunks(SEEDED_MAGIC, keys.data().size(), table_idxs, chunks, stream);
+    }
+
+    void save_seeded_key_chunks(const SEALContext &context, const SecretKey &secret_key, const RelinKeys &keys,
+                                ostream &stream) {
+        vector<uint64_t> table_idxs = nonempty_table_idxs(keys);
+        // KeyGenerator only creates relinearization keys for the square of the secret key
+        if (table_idxs != vector<uint64_t>{RelinKeys::get_index(2)}) {
+            LOG_AND_THROW_STREAM("Seeded relinearization keys are only supported for the square of the secret key");
+        }
+        KeyGenerator keygen(context, secret_key);
+        ostringstream chunk;
+        keygen.create_relin_keys().save(chunk, Serialization::compr_mode_default);
+        write_chunks(SEEDED_MAGIC, keys.data().size(), table_idxs, {chunk.str()}, stream);
+    }
+
+    bool has_key_chunks(istream &stream) {
+        return peek_magic(stream) != nullptr;
+    }
+
+    void load_key_chunks(const SEALContext &context, istream &stream, KSwitchKeys &keys) {
+        const char *magic = peek_magic(stream);
+        if (magic == nullptr) {
+            LOG_AND_THROW_STREAM("Error loading keys: the stream does not contain chunked keys");
+        }
+        bool seeded = magic == SEEDED_MAGIC;
+        stream.ignore(sizeof(MAGIC));
+        uint64_t table_size = read_u64(stream);
+        uint64_t num_chunks = read_u64(stream);
+        // The table has at most one entry per ring coefficient (for Galois keys)
+        size_t max_table_size = context.key_context_data()->parms().poly_modulus_degree();
+        size_t max_keys = context.key_context_data()->parms().coeff_modulus().size() - 1;
+        if (table_size > max_table_size || num_chunks > table_size) {
+            LOG_AND_THROW_STREAM("Error loading keys: invalid chunk index");
+        }
+
+        vector<uint64_t> table_idxs(num_chunks);
+        vector<uint64_t> chunk_sizes(num_chunks);
+        for (size_t i = 0; i < num_chunks; i++) {
+            table_idxs[i] = read_u64(stream);
+            chunk_sizes[i] = read_u64(stream);
+            if (table_idxs[i] >= table_size) {
+                LOG_AND_THROW_STREAM("Error loading keys: chunk " << i << " is out of bounds");
+            }
+        }
+        vector<string> chunks(num_chunks);
+        for (size_t i = 0; i < num_chunks; i++) {
+            read_chunk(stream, chunk_sizes[i], chunks[i]);
+        }
+
+        KSwitchKeys loaded;
+        loaded.data().resize(table_size);
+        // Errors are rethrown after the loop in chunk order, so the reported error does not depend on scheduling
+        vector<exception_ptr> errors(num_chunks);
+        parallel_for(num_chunks, [&](int i) {
+            try {
+                istringstream chunk(chunks[i]);
+                if (seeded) {
+                    // a key set holding a single seeded key; loading it expands the seed
+                    KSwitchKeys single_key;
+                    single_key.load(context, chunk);
+                    if (table_idxs[i] >= single_key.data().size() || single_key.data()[table_idxs[i]].empty()) {
+                        LOG_AND_THROW_STREAM("Error loading keys: chunk " << i << " does not contain its key");
+                    }
+                    loaded.data()[table_idxs[i]] = move(single_key.data()[table_idxs[i]]);
+                    return;
+                }
+                uint64_t num_keys = read_u64(chunk);
+                if (num_keys > max_keys) {
+                    LOG_AND_THROW_STREAM("Error loading keys: chunk " << i << " contains " << num_keys << " keys");
+                }
+                vector<PublicKey> &key = loaded.data()[table_idxs[i]];
+                key.resize(num_keys);
+                for (auto &k : key) {
+                    k.load(context, chunk);
+                }
+            } catch (...) {
+                errors[i] = current_exception();
+            }
+        });
+        for (const auto &error : errors) {
+            if (error != nullptr) {
+                rethrow_exception(error);
+            }
+        }
+
+        loaded.parms_id() = context.key_parms_id();
+        if (!is_valid_for(loaded, context)) {
+            LOG_AND_THROW_STREAM("Error loading keys: keys are not valid for the encryption parameters");
+        }
+        keys.data() = move(loaded.data());
+        keys.parms_id() = loaded.parms_id();
+    }
+
+    void load_keys(const SEALContext &context, istream &stream, KSwitchKeys &keys) {
+        if (has_key_chunks(stream)) {
+            load_key_chunks(context, stream, keys);
+        } else {
+            keys.load(context, stream);
+        }
+    }
+}  // namespace hit
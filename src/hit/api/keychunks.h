@@ -0,0 +1,46 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <iostream>
+
+#include "seal/seal.h"
+
+namespace hit {
+
+    /* An internal API for the HE backend.
+     * A chunked format for key-switching keys (Galois and relinearization keys). SEAL serializes a
+     * key set as a single object, which cannot be compressed when it is large
+     * (https://github.com/microsoft/SEAL/issues/142). Instead, each key in the set is serialized and
+     * compressed independently as a chunk, which is done in parallel, and the chunks are written after
+     * a small index. Chunks are likewise decompressed in parallel when loading.
+     *
+     * The format is an 8-byte magic string, the size of the key table (`seal::KSwitchKeys::data()`),
+     * the number of chunks, and a (table index, chunk size) pair for each chunk, followed by the chunks.
+     * Each chunk is the number of key-switching keys in the table entry, followed by the compressed
+     * SEAL serialization of each key. All integers are 64 bits, in native byte order.
+     */
+
+    void save_key_chunks(const seal::KSwitchKeys &keys, std::ostream &stream);
+
+    /* Write keys in a seeded form, in which half of each key is replaced by the seed of a pseudo-random
+     * generator. This roughly halves the size of the keys. SEAL can only produce seeded keys when they
+     * are generated, so these functions generate fresh keys (in parallel) for the same Galois elements
+     * as `keys`, using `secret_key`. The fresh keys are equivalent to `keys`, but not equal. Each parallel task
+     * uses its own seal::KeyGenerator, since SEAL does not document KeyGenerator as thread-safe.
+     * Seeded chunks are loaded by `load_key_chunks`, which expands the seeds.
+     */
+    void save_seeded_key_chunks(const seal::SEALContext &context, const seal::SecretKey &secret_key,
+                                const seal::GaloisKeys &keys, std::ostream &stream);
+    void save_seeded_key_chunks(const seal::SEALContext &context, const seal::SecretKey &secret_key,
+                                const seal::RelinKeys &keys, std::ostream &stream);
+
+    // Returns true if the stream starts with a chunked key set. The stream position is not changed.
+    bool has_key_chunks(std::istream &stream);
+
+    void load_key_chunks(const seal::SEALContext &context, std::istream &stream, seal::KSwitchKeys &keys);
+
+    // Load keys written either by `save_key_chunks` or by `seal::KSwitchKeys::save`.
+    void load_keys(const seal::SEALContext &context, std::istream &stream, seal::KSwitchKeys &keys);
+}  // namespace hit
@@ -0,0 +1,230 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "keystore.h"
+
+#include <glog/logging.h>
+
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <sstream>
+
+#include "../common.h"
+#include "context.h"
+#include "galoiskeyfile.h"
+#include "hit/protobuf/ckksparams.pb.h"
+#include "keychunks.h"
+
+using namespace std;
+using namespace seal;
+
+namespace hit {
+
+    KeyStore::KeyStore(const string &spill_dir, size_t memory_budget_bytes, size_t max_resident_galois_keys)
+        : spill_dir_(spill_dir),
+          memory_budget_bytes_(memory_budget_bytes),
+          max_resident_galois_keys_(max_resident_galois_keys) {
+    }
+
+    KeyStore::~KeyStore() {
+        for (const auto &entry : tenants_) {
+            remove(entry.second.params_file.c_str());
+            remove(entry.second.galois_key_file.c_str());
+            remove(entry.second.relin_key_file.c_str());
+        }
+    }
+
+    void KeyStore::add_tenant(const string &tenant, istream &params_stream, istream &galois_key_stream,
+                              istream &relin_key_stream) {
+        uint64_t file_id;
+        {
+            scoped_lock lock(mutex_);
+            if (tenants_.find(tenant) != tenants_.end()) {
+                LOG_AND_THROW_STREAM("The key store already contains tenant " << tenant);
+            }
+            file_id = next_file_id_++;
+        }
+
+        // Keys are converted and written to disk without holding the lock.
+        string params_bytes((istreambuf_iterator<char>(params_stream)), istreambuf_iterator<char>());
+        protobuf::CKKSParams ckks_params;
+        if (!ckks_params.ParseFromString(params_bytes)) {
+            LOG_AND_THROW_STREAM("Invalid parameters for tenant " << tenant);
+        }
+        EncryptionParameters params = EncryptionParameters(scheme_type::none);
+        istringstream ctxstream(ckks_params.ctx());
+        params.load(ctxstream);
+        shared_ptr<HEContext> context =
+            HEContext::shared(CKKSParams(params, ckks_params.logscale(), ckks_params.standardparams()));
+
+        GaloisKeys galois_keys;
+        load_keys(*(context->seal_ctx), galois_key_stream, galois_keys);
+        RelinKeys relin_keys;
+        load_keys(*(context->seal_ctx), relin_key_stream, relin_keys);
+
+        Tenant entry;
+        string prefix = spill_dir_ + "/tenant" + to_string(file_id);
+        entry.params_file = prefix + ".params";
+        entry.galois_key_file = prefix + ".galois";
+        entry.relin_key_file = prefix + ".relin";
+
+        ofstream params_file(entry.params_file, ios::binary | ios::trunc);
+        params_file.write(params_bytes.data(), params_bytes.size());
+        ofstream relin_key_file(entry.relin_key_file, ios::binary | ios::trunc);
+        save_key_chunks(relin_keys, relin_key_file);
+        if (!params_file || !relin_key_file) {
+            LOG_AND_THROW_STREAM("Error writing keys for tenant " << tenant << " to " << spill_dir_);
+        }
+        GaloisKeyFile::write(entry.galois_key_file, galois_keys);
+
+        // In memory, keys are roughly the size of their uncompressed serialization.
+        // The parameters are dominated by the public key.
+        size_t galois_bytes = static_cast<size_t>(galois_keys.save_size(compr_mode_type::none));
+        size_t num_galois_keys = galois_keys.size();
+        if (max_resident_galois_keys_ > 0 && max_resident_galois_keys_ < num_galois_keys) {
+            galois_bytes = galois_bytes / num_galois_keys * max_resident_galois_keys_;
+        }
+        entry.resident_size =
+            params_bytes.size() + static_cast<size_t>(relin_keys.save_size(compr_mode_type::none)) + galois_bytes;
+
+        scoped_lock lock(mutex_);
+        if (!tenants_.emplace(tenant, entry).second) {
+            remove(entry.params_file.c_str());
+            remove(entry.galois_key_file.c_str());
+            remove(entry.relin_key_file.c_str());
+            LOG_AND_THROW_STREAM("The key store already contains tenant " << tenant);
+        }
+    }
+
+    void KeyStore::remove_tenant(const string &tenant) {
+        scoped_lock lock(mutex_);
+        auto it = tenants_.find(tenant);
+        if (it == tenants_.end()) {
+            LOG_AND_THROW_STREAM("The key store does not contain tenant " << tenant);
+        }
+        // the memory of a tenant which is being loaded is already counted
+        if (it->second.eval != nullptr || it->second.loading.valid()) {
+            resident_bytes_ -= it->second.resident_size;
+        }
+        // an evaluator held by a caller keeps its memory-mapped Galois key file after it is removed
+        remove(it->second.params_file.c_str());
+        remove(it->second.galois_key_file.c_str());
+        remove(it->second.relin_key_file.c_str());
+        tenants_.erase(it);
+    }
+
+    bool KeyStore::has_tenant(const string &tenant) const {
+        scoped_lock lock(mutex_);
+        return tenants_.find(tenant) != tenants_.end();
+    }
+
+    shared_ptr<HomomorphicEval> KeyStore::evaluator(const string &tenant) {
+        promise<shared_ptr<HomomorphicEval>> loaded;
+        string params_file;
+        string galois_key_file;
+        string relin_key_file;
+        {
+            unique_lock lock(mutex_);
+            auto it = tenants_.find(tenant);
+            if (it == tenants_.end()) {
+                LOG_AND_THROW_STREAM("The key store does not contain tenant " << tenant);
+            }
+            Tenant &entry = it->second;
+            entry.last_use = ++clock_;
+            if (entry.eval != nullptr) {
+                return entry.eval;
+            }
+            if (entry.loading.valid()) {
+                shared_future<shared_ptr<HomomorphicEval>> loading = entry.loading;
+                lock.unlock();
+                return loading.get();
+            }
+
+            // Reserve the tenant's memory before loading it, so that concurrent loads respect the budget.
+            evict(entry.resident_size);
+            resident_bytes_ += entry.resident_size;
+            if (resident_bytes_ > memory_budget_bytes_) {
+                LOG(WARNING) << "Resident keys use " << resident_bytes_
+                             << " bytes, which exceeds the key store budget of " << memory_budget_bytes_
+                             << " bytes, because the evaluators of other tenants are in use.";
+            }
+            entry.loading = loaded.get_future().share();
+            params_file = entry.params_file;
+            galois_key_file = entry.galois_key_file;
+            relin_key_file = entry.relin_key_file;
+        }
+
+        // Reading the keys and setting up the context is slow, so other tenants are served in the meantime.
+        shared_ptr<HomomorphicEval> eval;
+        try {
+            ifstream params_stream(params_file, ios::binary);
+            ifstream relin_key_stream(relin_key_file, ios::binary);
+            if (!params_stream || !relin_key_stream) {
+                LOG_AND_THROW_STREAM("Unable to read keys for tenant " << tenant << " from " << spill_dir_);
+            }
+            eval = make_shared<HomomorphicEval>(params_stream, galois_key_file, relin_key_stream,
+                                                max_resident_galois_keys_);
+        } catch (...) {
+            {
+                scoped_lock lock(mutex_);
+                auto it = tenants_.find(tenant);
+                // the tenant may have been removed (and possibly added again) while it was loading
+                if (it != tenants_.end() && it->second.params_file == params_file) {
+                    resident_bytes_ -= it->second.resident_size;
+                    it->second.loading = shared_future<shared_ptr<HomomorphicEval>>();
+                }
+            }
+            loaded.set_exception(current_exception());
+            throw;
+        }
+
+        {
+            scoped_lock lock(mutex_);
+            auto it = tenants_.find(tenant);
+            if (it != tenants_.end() && it->second.params_file == params_file) {
+                it->second.eval = eval;
+                it->second.loading = shared_future<shared_ptr<HomomorphicEval>>();
+            }
+        }
+        loaded.set_value(eval);
+        return eval;
+    }
+
+    void KeyStore::evict(size_t bytes) {
+        while (resident_bytes_ + bytes > memory_budget_bytes_) {
+            Tenant *lru = nullptr;
+            for (auto &entry : tenants_) {
+                Tenant &candidate = entry.second;
+                // The store holds the only reference to evaluators which are not in use. Since new references
+                // are only created while holding the lock, such an evaluator cannot come into use here.
+                if (candidate.eval != nullptr && candidate.eval.use_count() == 1 &&
+                    (lru == nullptr || candidate.last_use < lru->last_use)) {
+                    lru = &candidate;
+                }
+            }
+            if (lru == nullptr) {
+                return;
+            }
+            lru->eval.reset();
+            resident_bytes_ -= lru->resident_size;
+        }
+    }
+
+    size_t KeyStore::resident_bytes() const {
+        scoped_lock lock(mutex_);
+        return resident_bytes_;
+    }
+
+    size_t KeyStore::num_resident_tenants() const {
+        scoped_lock lock(mutex_);
+        size_t count = 0;
+        for (const auto &entry : tenants_) {
+            if (entry.second.eval != nullptr) {
+                count++;
+            }
+        }
+        return count;
+    }
+}  // namespace hit
@@ -0,0 +1,97 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstdint>
+#include <future>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "evaluator/homomorphic.h"
+
+namespace hit {
+
+    /* A store of evaluation keys for many tenants (clients), each with their own keys, which
+     * hands out evaluators for each tenant while bounding the memory used by keys.
+     *
+     * When a tenant is added, its keys are written to a directory on disk. Evaluators are created from
+     * these files on demand: Galois keys are loaded lazily from a `GaloisKeyFile`, and tenants with
+     * identical parameters share a single `HEContext`. The store tracks an estimate of the memory used
+     * by each resident evaluator. When loading a tenant would exceed the memory budget, the evaluators
+     * of the least-recently used tenants are dropped; their keys remain on disk and are reloaded when
+     * the tenant is next used.
+     *
+     * An evaluator is never dropped while a caller holds it, so the budget may be exceeded when more
+     * tenants are in use at once than fit in the budget. All member functions are thread-safe.
+     */
+    class KeyStore {
+       public:
+        /* `spill_dir` is an existing directory in which the store keeps tenant keys; it should not be
+         * shared with another store. `memory_budget_bytes` bounds the estimated size of resident keys.
+         * If `max_resident_galois_keys` is positive, each evaluator keeps at most this many Galois keys
+         * in memory (see `HomomorphicEval`); otherwise every Galois key of a resident tenant counts
+         * against the budget.
+         */
+        KeyStore(const std::string &spill_dir, size_t memory_budget_bytes, size_t max_resident_galois_keys = 0);
+
+        // Deletes the key files of all tenants. Evaluators held by callers remain usable.
+        ~KeyStore();
+
+        KeyStore(const KeyStore &) = delete;
+        KeyStore &operator=(const KeyStore &) = delete;
+        KeyStore(KeyStore &&) = delete;
+        KeyStore &operator=(KeyStore &&) = delete;
+
+        /* Add a tenant from the output of `HomomorphicEval::save`. The tenant is not loaded until its
+         * evaluator is requested.
+         */
+        void add_tenant(const std::string &tenant, std::istream &params_stream, std::istream &galois_key_stream,
+                        std::istream &relin_key_stream);
+
+        void remove_tenant(const std::string &tenant);
+
+        bool has_tenant(const std::string &tenant) const;
+
+        /* Returns an evaluation instance for `tenant`, loading it if it is not resident.
+         * The instance stays resident at least as long as the caller holds the returned pointer.
+         */
+        std::shared_ptr<HomomorphicEval> evaluator(const std::string &tenant);
+
+        // The estimated number of bytes used by the keys of resident tenants, including tenants being loaded.
+        size_t resident_bytes() const;
+
+        size_t num_resident_tenants() const;
+
+       private:
+        struct Tenant {
+            std::string params_file;
+            std::string galois_key_file;
+            std::string relin_key_file;
+            // estimated memory used by a resident evaluator for this tenant
+            size_t resident_size;
+            std::shared_ptr<HomomorphicEval> eval;
+            // Valid while a thread is loading the evaluator, which is done without holding the lock.
+            // Other threads which request the tenant wait for this result instead of loading it again.
+            std::shared_future<std::shared_ptr<HomomorphicEval>> loading;
+            uint64_t last_use = 0;
+        };
+
+        // Drop the least-recently used evaluators which are not in use until `bytes` more bytes fit in the budget.
+        void evict(size_t bytes);
+
+        std::string spill_dir_;
+        size_t memory_budget_bytes_;
+        size_t max_resident_galois_keys_;
+
+        mutable std::mutex mutex_;
+        std::map<std::string, Tenant> tenants_;
+        size_t resident_bytes_ = 0;
+        uint64_t clock_ = 0;
+        // used to name key files, since tenant names may not be valid file names
+        uint64_t next_file_id_ = 0;
+    };
+}  // namespace hit
@@ -0,0 +1,66 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "../../common.h"
+#include "../../scheduler.h"
+#include "../ciphertext.h"
+
+namespace hit {
+
+    /* An EncryptedMatrix, EncryptedRowVector, or EncryptedColVector which is computed asynchronously by the
+     * `*_async` functions of LinearAlgebra. The dimensions and encoding unit of the object are known as soon as
+     * the operation which computes it is scheduled, but each of its encoding units is a separate future. An
+     * asynchronous operation which reads this object computes each unit of its output as soon as the input
+     * units it depends on are ready, rather than waiting for the entire object.
+     */
+    template <typename T>
+    class AsyncEncrypted {
+       public:
+        // An uninitialized object, which cannot be used as an input.
+        AsyncEncrypted() = default;
+
+        // An object whose units are already computed.
+        explicit AsyncEncrypted(const T &value) : shape_(value), units_(value.num_cts()) {
+            TRY_AND_THROW_STREAM(value.validate(), "Argument to AsyncEncrypted is invalid; has it been initialized?");
+            for (size_t i = 0; i < units_.size(); i++) {
+                units_[i] = make_ready_future(value[i]);
+                // the shape only holds the dimensions and encoding unit
+                shape_[i] = CKKSCiphertext();
+            }
+        }
+
+        // Block until every unit is computed, and return the object. If a unit holds an exception, it is rethrown.
+        T get() const {
+            T result = shape_;
+            for (size_t i = 0; i < units_.size(); i++) {
+                result[i] = units_[i].get();
+            }
+            result.validate();
+            return result;
+        }
+
+        // Block until every unit is computed.
+        void wait() const {
+            for (const auto &unit : units_) {
+                unit.wait();
+            }
+        }
+
+       private:
+        AsyncEncrypted(T shape, std::vector<Future<CKKSCiphertext>> units)
+            : shape_(std::move(shape)), units_(std::move(units)) {
+        }
+
+        // an object with the dimensions and encoding unit of this object, whose ciphertexts are placeholders
+        T shape_;
+        // the units of this object, in the order of `T::operator[]`
+        std::vector<Future<CKKSCiphertext>> units_;
+
+        friend class LinearAlgebra;
+    };
+}  // namespace hit
@@ -10,6 +10,9 @@
 
 namespace hit {
 
+    template <typename T>
+    class AsyncEncrypted;
+
     /* One or more ciphertexts which encrypts a plaintext column vector.
      * Column vectors are encoded as the *rows* of an encoding unit,
      * where each row is identical.
@@ -99,6 +102,7 @@ namespace hit {
         bool same_size(const EncryptedColVector &enc_vec) const;
 
         friend class LinearAlgebra;
+        friend class AsyncEncrypted<EncryptedColVector>;
     };
 
     // Encode a column vector as a sequence of plaintext matrices which encode the vector
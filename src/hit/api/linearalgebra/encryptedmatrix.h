@@ -10,6 +10,9 @@
 
 namespace hit {
 
+    template <typename T>
+    class AsyncEncrypted;
+
     /* One or more ciphertexts which encrypts a plaintext matrix.
      * Matrices are divided into plaintexts by tiling the matrix with the encoding unit.
      * If the matrix dimensions do not exactly divide into encoding units, extra space is
@@ -113,6 +116,7 @@ namespace hit {
         bool same_size(const EncryptedMatrix &enc_mat) const;
 
         friend class LinearAlgebra;
+        friend class AsyncEncrypted<EncryptedMatrix>;
     };
 
     // Encode a matrix as a sequence of plaintext matrices which encode the matrix
@@ -10,6 +10,9 @@
 
 namespace hit {
 
+    template <typename T>
+    class AsyncEncrypted;
+
     /* One or more ciphertexts which encrypts a plaintext row vector.
      * Row vectors are encoded as the *columns* of an encoding unit,
      * where each column is identical.
@@ -115,6 +118,7 @@ namespace hit {
         bool same_size(const EncryptedRowVector &enc_vec) const;
 
         friend class LinearAlgebra;
+        friend class AsyncEncrypted<EncryptedRowVector>;
     };
 
     // Encode a row vector as a sequence of plaintext matrices which encode the vector
@@ -5,6 +5,8 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
+
 using namespace std;
 
 namespace hit {
@@ -30,27 +32,40 @@ namespace hit {
 
     EncryptedMatrix LinearAlgebra::encrypt_matrix_internal(
         const Matrix &mat, const EncodingUnit &unit,
-        function<CKKSCiphertext(CKKSEvaluator &, const vector<double> &)> encrypt) {  // NOLINT
+        function<vector<CKKSCiphertext>(CKKSEvaluator &, const vector<vector<double>> &)> encrypt_many) {  // NOLINT
         vector<vector<Matrix>> mat_pieces = encode_matrix(mat, unit);
-        vector<vector<CKKSCiphertext>> mat_cts(mat_pieces.size());
-        for (int i = 0; i < mat_pieces.size(); i++) {
-            vector<CKKSCiphertext> row_cts(mat_pieces[0].size());
-            for (int j = 0; j < mat_pieces[0].size(); j++) {
-                row_cts[j] = encrypt(eval, mat_pieces[i][j].data());
+        int num_vertical_units = mat_pieces.size();
+        int num_horizontal_units = mat_pieces[0].size();
+
+        // encrypt all units as a single batch, in row-major order
+        vector<vector<double>> unit_coeffs;
+        unit_coeffs.reserve(num_vertical_units * num_horizontal_units);
+        for (auto &row_pieces : mat_pieces) {
+            for (auto &piece : row_pieces) {
+                // the encoded pieces are not used after this point, so avoid copying the data
+                unit_coeffs.push_back(move(piece.data()));
             }
-            mat_cts[i] = row_cts;
+        }
+        vector<CKKSCiphertext> cts = encrypt_many(eval, unit_coeffs);
+
+        vector<vector<CKKSCiphertext>> mat_cts(num_vertical_units);
+        for (int i = 0; i < num_vertical_units; i++) {
+            mat_cts[i] = vector<CKKSCiphertext>(cts.begin() + i * num_horizontal_units,
+                                                cts.begin() + (i + 1) * num_horizontal_units);
         }
         return EncryptedMatrix(mat.size1(), mat.size2(), unit, mat_cts);
     }
 
     EncryptedMatrix LinearAlgebra::encrypt_matrix(const Matrix &mat, const EncodingUnit &unit) {
-        auto lambda = [](CKKSEvaluator &eval_, const vector<double> &m) -> CKKSCiphertext { return eval_.encrypt(m); };
+        auto lambda = [](CKKSEvaluator &eval_, const vector<vector<double>> &m) -> vector<CKKSCiphertext> {
+            return eval_.encrypt_many(m);
+        };
         return encrypt_matrix_internal(mat, unit, lambda);
     }
 
     EncryptedMatrix LinearAlgebra::encrypt_matrix(const Matrix &mat, const EncodingUnit &unit, int level) {
-        auto lambda = [&](CKKSEvaluator &eval_, const vector<double> &m) -> CKKSCiphertext {
-            return eval_.encrypt(m, level);
+        auto lambda = [&](CKKSEvaluator &eval_, const vector<vector<double>> &m) -> vector<CKKSCiphertext> {
+            return eval_.encrypt_many(m, level);
         };
         return encrypt_matrix_internal(mat, unit, lambda);
     }
@@ -63,16 +78,31 @@ namespace hit {
             decryption_warning(enc_mat.he_level());
         }
 
-        vector<vector<Matrix>> mat_pieces(enc_mat.cts.size());
-        for (int i = 0; i < enc_mat.cts.size(); i++) {
-            vector<Matrix> row_pieces(enc_mat.cts[0].size());
-            for (int j = 0; j < enc_mat.cts[0].size(); j++) {
-                row_pieces[j] = Matrix(enc_mat.encoding_unit().encoding_height(),
-                                       enc_mat.encoding_unit().encoding_width(), eval.decrypt(enc_mat.cts[i][j], true));
+        int unit_height = enc_mat.encoding_unit().encoding_height();
+        int unit_width = enc_mat.encoding_unit().encoding_width();
+        int num_horizontal_units = enc_mat.num_horizontal_units();
+
+        vector<const CKKSCiphertext *> cts;
+        cts.reserve(enc_mat.num_vertical_units() * num_horizontal_units);
+        for (const auto &row_cts : enc_mat.cts) {
+            for (const auto &ct : row_cts) {
+                cts.push_back(&ct);
             }
-            mat_pieces[i] = row_pieces;
         }
-        return decode_matrix(mat_pieces, enc_mat.height(), enc_mat.width());
+
+        // Decode each unit directly into the output matrix, as in decode_matrix.
+        // Each unit writes to a disjoint region of the output, so units may be decoded concurrently.
+        Matrix result(enc_mat.height(), enc_mat.width());
+        eval.decrypt_many(cts, [&](int idx, const vector<double> &unit_coeffs) {
+            int unit_row = idx / num_horizontal_units;
+            int unit_col = idx % num_horizontal_units;
+            for (int k = 0; k < unit_height && unit_row * unit_height + k < enc_mat.height(); k++) {
+                for (int l = 0; l < unit_width && unit_col * unit_width + l < enc_mat.width(); l++) {
+                    result(unit_row * unit_height + k, unit_col * unit_width + l) = unit_coeffs[k * unit_width + l];
+                }
+            }
+        });
+        return result;
     }
 
     template <>
@@ -92,23 +122,26 @@ namespace hit {
 
     EncryptedRowVector LinearAlgebra::encrypt_row_vector_internal(
         const Vector &vec, const EncodingUnit &unit,
-        function<CKKSCiphertext(CKKSEvaluator &, const vector<double> &)> encrypt) {  // NOLINT
+        function<vector<CKKSCiphertext>(CKKSEvaluator &, const vector<vector<double>> &)> encrypt_many) {  // NOLINT
         vector<Matrix> vec_pieces = encode_row_vector(vec, unit);
-        vector<CKKSCiphertext> vec_cts(vec_pieces.size());
-        for (int i = 0; i < vec_pieces.size(); i++) {
-            vec_cts[i] = encrypt(eval, vec_pieces[i].data());
+        vector<vector<double>> unit_coeffs;
+        unit_coeffs.reserve(vec_pieces.size());
+        for (auto &piece : vec_pieces) {
+            unit_coeffs.push_back(move(piece.data()));
         }
-        return EncryptedRowVector(vec.size(), unit, vec_cts);
+        return EncryptedRowVector(vec.size(), unit, encrypt_many(eval, unit_coeffs));
     }
 
     EncryptedRowVector LinearAlgebra::encrypt_row_vector(const Vector &vec, const EncodingUnit &unit) {
-        auto lambda = [](CKKSEvaluator &eval_, const vector<double> &m) -> CKKSCiphertext { return eval_.encrypt(m); };
+        auto lambda = [](CKKSEvaluator &eval_, const vector<vector<double>> &m) -> vector<CKKSCiphertext> {
+            return eval_.encrypt_many(m);
+        };
         return encrypt_row_vector_internal(vec, unit, lambda);
     }
 
     EncryptedRowVector LinearAlgebra::encrypt_row_vector(const Vector &vec, const EncodingUnit &unit, int level) {
-        auto lambda = [&](CKKSEvaluator &eval_, const vector<double> &m) -> CKKSCiphertext {
-            return eval_.encrypt(m, level);
+        auto lambda = [&](CKKSEvaluator &eval_, const vector<vector<double>> &m) -> vector<CKKSCiphertext> {
+            return eval_.encrypt_many(m, level);
         };
         return encrypt_row_vector_internal(vec, unit, lambda);
     }
@@ -121,12 +154,24 @@ namespace hit {
             decryption_warning(enc_vec.he_level());
         }
 
-        vector<Matrix> vec_pieces(enc_vec.cts.size());
-        for (int i = 0; i < enc_vec.cts.size(); i++) {
-            vec_pieces[i] = Matrix(enc_vec.encoding_unit().encoding_height(), enc_vec.encoding_unit().encoding_width(),
-                                   eval.decrypt(enc_vec.cts[i], true));
+        int unit_height = enc_vec.encoding_unit().encoding_height();
+        int unit_width = enc_vec.encoding_unit().encoding_width();
+
+        vector<const CKKSCiphertext *> cts;
+        cts.reserve(enc_vec.cts.size());
+        for (const auto &ct : enc_vec.cts) {
+            cts.push_back(&ct);
         }
-        return decode_row_vector(vec_pieces, enc_vec.width());
+
+        // Row vectors are encoded as columns; copy the first column of each unit directly
+        // into the output vector, as in decode_row_vector.
+        Vector result(enc_vec.width());
+        eval.decrypt_many(cts, [&](int i, const vector<double> &unit_coeffs) {
+            for (int k = 0; k < unit_height && i * unit_height + k < enc_vec.width(); k++) {
+                result[i * unit_height + k] = unit_coeffs[k * unit_width];
+            }
+        });
+        return result;
     }
 
     template <>
@@ -136,23 +181,26 @@ namespace hit {
 
     EncryptedColVector LinearAlgebra::encrypt_col_vector_internal(
         const Vector &vec, const EncodingUnit &unit,
-        function<CKKSCiphertext(CKKSEvaluator &, const vector<double> &)> encrypt) {  // NOLINT
+        function<vector<CKKSCiphertext>(CKKSEvaluator &, const vector<vector<double>> &)> encrypt_many) {  // NOLINT
         vector<Matrix> vec_pieces = encode_col_vector(vec, unit);
-        vector<CKKSCiphertext> vec_cts(vec_pieces.size());
-        for (int i = 0; i < vec_pieces.size(); i++) {
-            vec_cts[i] = encrypt(eval, vec_pieces[i].data());
+        vector<vector<double>> unit_coeffs;
+        unit_coeffs.reserve(vec_pieces.size());
+        for (auto &piece : vec_pieces) {
+            unit_coeffs.push_back(move(piece.data()));
         }
-        return EncryptedColVector(vec.size(), unit, vec_cts);
+        return EncryptedColVector(vec.size(), unit, encrypt_many(eval, unit_coeffs));
     }
 
     EncryptedColVector LinearAlgebra::encrypt_col_vector(const Vector &vec, const EncodingUnit &unit) {
-        auto lambda = [](CKKSEvaluator &eval_, const vector<double> &m) -> CKKSCiphertext { return eval_.encrypt(m); };
+        auto lambda = [](CKKSEvaluator &eval_, const vector<vector<double>> &m) -> vector<CKKSCiphertext> {
+            return eval_.encrypt_many(m);
+        };
         return encrypt_col_vector_internal(vec, unit, lambda);
     }
 
     EncryptedColVector LinearAlgebra::encrypt_col_vector(const Vector &vec, const EncodingUnit &unit, int level) {
-        auto lambda = [&](CKKSEvaluator &eval_, const vector<double> &m) -> CKKSCiphertext {
-            return eval_.encrypt(m, level);
+        auto lambda = [&](CKKSEvaluator &eval_, const vector<vector<double>> &m) -> vector<CKKSCiphertext> {
+            return eval_.encrypt_many(m, level);
         };
         return encrypt_col_vector_internal(vec, unit, lambda);
     }
@@ -169,15 +217,34 @@ namespace hit {
             decryption_warning(enc_vec.he_level());
         }
 
-        vector<Matrix> vec_pieces(enc_vec.cts.size());
-        for (int i = 0; i < enc_vec.cts.size(); i++) {
-            vec_pieces[i] = Matrix(enc_vec.encoding_unit().encoding_height(), enc_vec.encoding_unit().encoding_width(),
-                                   eval.decrypt(enc_vec.cts[i], true));
+        int unit_width = enc_vec.encoding_unit().encoding_width();
+
+        vector<const CKKSCiphertext *> cts;
+        cts.reserve(enc_vec.cts.size());
+        for (const auto &ct : enc_vec.cts) {
+            cts.push_back(&ct);
         }
-        return decode_col_vector(vec_pieces, enc_vec.height());
+
+        // Column vectors are encoded as rows; copy the first row of each unit directly
+        // into the output vector, as in decode_col_vector.
+        Vector result(enc_vec.height());
+        eval.decrypt_many(cts, [&](int i, const vector<double> &unit_coeffs) {
+            for (int l = 0; l < unit_width && i * unit_width + l < enc_vec.height(); l++) {
+                result[i * unit_width + l] = unit_coeffs[l];
+            }
+        });
+        return result;
+    }
+
+    LinearAlgebra::LinearAlgebra(CKKSEvaluator &eval, int max_concurrency) : eval(eval), scheduler_(max_concurrency) {
     }
 
-    LinearAlgebra::LinearAlgebra(CKKSEvaluator &eval) : eval(eval) {
+    const TaskScheduler &LinearAlgebra::scheduler() const {
+        return scheduler_;
+    }
+
+    void LinearAlgebra::wait() {
+        scheduler_.wait();
     }
 
     // explicit template instantiation
@@ -444,7 +511,7 @@ namespace hit {
 
         vector<vector<CKKSCiphertext>> cts = enc_mat.cts;
 
-        parallel_for(enc_mat.num_vertical_units() * enc_mat.num_horizontal_units(), [&](int i) {
+        scheduler_.parallel_for_each(enc_mat.num_vertical_units() * enc_mat.num_horizontal_units(), [&](int i) {
             int unit_row = i / enc_mat.num_horizontal_units();
             int unit_col = i % enc_mat.num_horizontal_units();
             eval.multiply_inplace(cts[unit_row][unit_col], enc_vec.cts[unit_row]);
@@ -455,6 +522,21 @@ namespace hit {
 
     EncryptedMatrix LinearAlgebra::hadamard_multiply(const EncryptedMatrix &enc_mat,
                                                      const EncryptedColVector &enc_vec) {
+        hadamard_multiply_validation(enc_mat, enc_vec);
+
+        vector<vector<CKKSCiphertext>> cts = enc_mat.cts;
+
+        scheduler_.parallel_for_each(enc_mat.num_vertical_units() * enc_mat.num_horizontal_units(), [&](int i) {
+            int unit_row = i / enc_mat.num_horizontal_units();
+            int unit_col = i % enc_mat.num_horizontal_units();
+            eval.multiply_inplace(cts[unit_row][unit_col], enc_vec.cts[unit_col]);
+        });
+
+        return EncryptedMatrix(enc_mat.height(), enc_mat.width(), enc_mat.encoding_unit(), cts);
+    }
+
+    void LinearAlgebra::hadamard_multiply_validation(const EncryptedMatrix &enc_mat,
+                                                     const EncryptedColVector &enc_vec) {
         TRY_AND_THROW_STREAM(enc_mat.validate(),
                              "The EncryptedMatrix argument to hadamard_multiply is invalid; has it been initialized?");
         TRY_AND_THROW_STREAM(
@@ -484,16 +566,6 @@ namespace hit {
             LOG_AND_THROW_STREAM("Inputs to hadamard_multiply must be linear ciphertexts: "
                                  << "Vector: " << enc_mat.needs_relin() << ", Matrix: " << enc_vec.needs_relin());
         }
-
-        vector<vector<CKKSCiphertext>> cts = enc_mat.cts;
-
-        parallel_for(enc_mat.num_vertical_units() * enc_mat.num_horizontal_units(), [&](int i) {
-            int unit_row = i / enc_mat.num_horizontal_units();
-            int unit_col = i % enc_mat.num_horizontal_units();
-            eval.multiply_inplace(cts[unit_row][unit_col], enc_vec.cts[unit_col]);
-        });
-
-        return EncryptedMatrix(enc_mat.height(), enc_mat.width(), enc_mat.encoding_unit(), cts);
     }
 
     EncryptedColVector LinearAlgebra::multiply(const EncryptedRowVector &enc_vec, const EncryptedMatrix &enc_mat) {
@@ -506,29 +578,32 @@ namespace hit {
 
     EncryptedRowVector LinearAlgebra::multiply(const EncryptedMatrix &enc_mat, const EncryptedColVector &enc_vec,
                                                double scalar) {
-        // input validation by hadamard_multiply
-        EncryptedMatrix hadmard_prod = hadamard_multiply(enc_mat, enc_vec);
-        relinearize_inplace(hadmard_prod);
-        rescale_to_next_inplace(hadmard_prod);
-        return sum_cols(hadmard_prod, scalar);
-    }
+        hadamard_multiply_validation(enc_mat, enc_vec);
 
-    /* Computes (the encoding of) the k^th column of B, given B^T */
-    EncryptedColVector LinearAlgebra::extract_col(const EncryptedMatrix &enc_mat_b_trans, int col) {
-        EncodingUnit unit = enc_mat_b_trans.encoding_unit();
+        // Rather than computing the Hadamard product and summing the units in each row,
+        // compute the sum of the products of each row of units with the vector directly.
+        // This requires only one relinearization per row of units, rather than one per unit.
+        vector<CKKSCiphertext> cts(enc_mat.num_vertical_units());
+        scheduler_.parallel_for_each(enc_mat.num_vertical_units(), [&](int i) {
+            cts[i] = sum_cols_core(eval.inner_product(enc_mat.cts[i], enc_vec.cts), enc_mat.encoding_unit(), scalar);
+        });
+
+        return EncryptedRowVector(enc_mat.height(), enc_mat.encoding_unit(), cts);
+    }
 
+    /* Computes one unit of (the encoding of) the k^th column of B, given the unit of B^T which contains it */
+    CKKSCiphertext LinearAlgebra::extract_col_unit(const CKKSCiphertext &b_trans_unit, const EncodingUnit &unit,
+                                                   int col) {
         // create a mask for the k^th row of B^T, which is the k^th column of B
-        // row_mask is a single encoding unit which will be replicated for every
+        // row_mask is a single encoding unit which is the same for every
         // horizontal unit of the encoding of B^T
-        vector<double> row_mask(enc_mat_b_trans.num_slots());
+        vector<double> row_mask(b_trans_unit.num_slots());
 
-        // compute which unit row the desired column is in
-        int unit_row = col / unit.encoding_height();
         // row_in_unit is the row within the encoding unit that contains the masked row
         int row_in_unit = col % unit.encoding_height();
 
         // create the column mask encoding unit
-        for (size_t i = 0; i < enc_mat_b_trans.num_slots(); i++) {
+        for (size_t i = 0; i < b_trans_unit.num_slots(); i++) {
             if (i / unit.encoding_width() == row_in_unit) {
                 row_mask[i] = 1;
             } else {
@@ -536,141 +611,116 @@ namespace hit {
             }
         }
 
-        vector<CKKSCiphertext> isolated_row_cts(enc_mat_b_trans.num_horizontal_units());
-        parallel_for(enc_mat_b_trans.num_horizontal_units(), [&](int j) {
-            isolated_row_cts[j] = eval.multiply_plain(enc_mat_b_trans.cts[unit_row][j], row_mask);
-            eval.rescale_to_next_inplace(isolated_row_cts[j]);
-            // we now have isolated the k^th row of B^T. To get an encoding of the k^th column of B
-            // we need to replicate this row across all rows of the encoding unit
-
-            // An easy way to do this is to invoke sum_rows,
-            // but it requires some packing and unpacking.
-            // [Note: sum_rows nominally spawns new threads, but this matrix only has a
-            //  single unit, so no additional threads are created.
-            // First, compute the j^th component of the k^th column of B
-            // Then place it in isolated_row_cts
-            isolated_row_cts[j] = sum_rows_core(
-                EncryptedMatrix(unit.encoding_height(), unit.encoding_width(), unit,
-                                vector<vector<CKKSCiphertext>>{vector<CKKSCiphertext>{isolated_row_cts[j]}}),
-                0, false);
-        });
-        return EncryptedColVector(enc_mat_b_trans.width(), unit, isolated_row_cts);
-    }
+        CKKSCiphertext isolated_row = eval.multiply_plain_rescale(b_trans_unit, row_mask);
+        // we now have isolated the k^th row of B^T. To get an encoding of the k^th column of B
+        // we need to replicate this row across all rows of the encoding unit
 
-    /* Computes (the encoding of) the k^th row of A, given A^T */
-    EncryptedRowVector LinearAlgebra::extract_row(const EncryptedMatrix &enc_mat_a_trans, int row) {
-        EncodingUnit unit = enc_mat_a_trans.encoding_unit();
+        // An easy way to do this is to invoke sum_rows_core,
+        // but it requires some packing and unpacking.
+        return sum_rows_core(EncryptedMatrix(unit.encoding_height(), unit.encoding_width(), unit,
+                                             vector<vector<CKKSCiphertext>>{vector<CKKSCiphertext>{isolated_row}}),
+                             0, false);
+    }
 
+    /* Computes one unit of (the encoding of) the k^th row of A, given the unit of A^T which contains it */
+    CKKSCiphertext LinearAlgebra::extract_row_unit(const CKKSCiphertext &a_trans_unit, const EncodingUnit &unit,
+                                                   int row) {
         // create a mask for the k^th column of A^T, which is the k^th row of A
-        // col_mask is a single encoding unit which will be replicated for every
+        // col_mask is a single encoding unit which is the same for every
         // vertical unit of the encoding of A^T
-        vector<double> col_mask(enc_mat_a_trans.num_slots());
+        vector<double> col_mask(a_trans_unit.num_slots());
 
-        // compute which unit column the desired row is in
-        int unit_col = row / unit.encoding_width();
         // col_in_unit is the column within the encoding unit that contains the masked column
         int col_in_unit = row % unit.encoding_width();
 
         // create the column mask encoding unit
-        for (size_t i = 0; i < enc_mat_a_trans.num_slots(); i++) {
-            if (i % unit.encoding_width() == col_in_unit) {
-                col_mask[i] = 1;
+        for (size_t s = 0; s < a_trans_unit.num_slots(); s++) {
+            if (s % unit.encoding_width() == col_in_unit) {
+                col_mask[s] = 1;
             } else {
-                col_mask[i] = 0;
+                col_mask[s] = 0;
             }
         }
 
-        vector<CKKSCiphertext> isolated_col_cts(enc_mat_a_trans.num_vertical_units());
-        parallel_for(enc_mat_a_trans.num_vertical_units(), [&](int i) {
-            isolated_col_cts[i] = eval.multiply_plain(enc_mat_a_trans.cts[i][unit_col], col_mask);
-            eval.rescale_to_next_inplace(isolated_col_cts[i]);
-            // we now have isolated the k^th column of A^T. To get an encoding of the k^th row of A
-            // we need to replicate this column across all columns of the encoding unit
+        CKKSCiphertext isolated_col = eval.multiply_plain_rescale(a_trans_unit, col_mask);
+        // we now have isolated the k^th column of A^T. To get an encoding of the k^th row of A
+        // we need to replicate this column across all columns of the encoding unit
 
-            // first step is to shift the column to the left
-            if (col_in_unit != 0) {
-                eval.rotate_left_inplace(isolated_col_cts[i], col_in_unit);
-            }
+        // first step is to shift the column to the left
+        if (col_in_unit != 0) {
+            eval.rotate_left_inplace(isolated_col, col_in_unit);
+        }
 
-            // now replicate this column to all other columns of the unit
-            rot(isolated_col_cts[i], unit.encoding_width(), 1, false);
-        });
-        return EncryptedRowVector(enc_mat_a_trans.height(), unit, isolated_col_cts);
+        // now replicate this column to all other columns of the unit
+        rot(isolated_col, unit.encoding_width(), 1, false);
+        return isolated_col;
     }
 
-    /* Computes the k^th column of c*A*B given A and B^T, but NOT encoded as a vector.
-     * First, mask out the k^th row of B^T, which is the k^th column of B.
-     * The goal is to replicate this row to get the encoding of the k^th column of A (as columns)
+    /* Computes the i^th unit of the k^th column of c*A*B given the i^th row of units of A and the encoding of
+     * the k^th column of B, but NOT encoded as a vector: only the k^th column of the unit is non-zero.
      */
-    EncryptedRowVector LinearAlgebra::matrix_matrix_mul_loop_col_major(const EncryptedMatrix &enc_mat_a,
-                                                                       const EncryptedMatrix &enc_mat_b_trans,
-                                                                       double scalar, int k) {
-        EncryptedColVector kth_col_B = extract_col(enc_mat_b_trans, k);
-        EncodingUnit unit = enc_mat_a.encoding_unit();
-
+    CKKSCiphertext LinearAlgebra::matrix_matrix_mul_unit_col_major(const vector<CKKSCiphertext> &unit_row_a,
+                                                                   const vector<CKKSCiphertext> &kth_col_b_cts,
+                                                                   const EncodingUnit &unit, double scalar, int k) {
         // We could just use `multiply` here, but it's inefficient:
-        // it would call hadamard_multiply, followed by `sum_cols` to
-        // create an encoding of the output vector.
+        // it would call `sum_cols` to create an encoding of the output vector.
         // Our goal is to output a single copy of the output column,
         // but NOT replicate it; we will add it to the other columns later
         // By manulaly performing the `sum_cols` step, we can accomplish
         // several other tasks simultaneously.
-        EncryptedMatrix hmul_A_times_kth_col_B = hadamard_multiply(enc_mat_a, kth_col_B);
-        relinearize_inplace(hmul_A_times_kth_col_B);
-        rescale_to_next_inplace(hmul_A_times_kth_col_B);
 
         // create a mask for the first column
-        int num_slots = enc_mat_b_trans.num_slots();
+        int num_slots = unit_row_a[0].num_slots();
         vector<double> col_mask(num_slots);
-        for (int i = 0; i < num_slots; i++) {
-            if (i % unit.encoding_width() == 0) {
-                col_mask[i] = scalar;
+        for (int s = 0; s < num_slots; s++) {
+            if (s % unit.encoding_width() == 0) {
+                col_mask[s] = scalar;
             } else {
-                col_mask[i] = 0;
+                col_mask[s] = 0;
             }
         }
 
-        vector<CKKSCiphertext> row_cts(enc_mat_a.num_vertical_units());
-        parallel_for(enc_mat_a.num_vertical_units(), [&](int i) {
-            // sum the units in this row
-            CKKSCiphertext unit_sum = eval.add_many(hmul_A_times_kth_col_B.cts[i]);
-            // sum the columns of the unit, putting the result in the first column
-            rot(unit_sum, unit.encoding_width(), 1, true);
+        // multiply each unit in this row by the corresponding unit of the column, and sum the results
+        CKKSCiphertext unit_sum = eval.inner_product(unit_row_a, kth_col_b_cts);
+        // sum the columns of the unit, putting the result in the first column
+        rot(unit_sum, unit.encoding_width(), 1, true);
 
-            // scale and mask out first column
-            row_cts[i] = eval.multiply_plain(unit_sum, col_mask);
-            // shift to the target column
-            eval.rotate_right_inplace(row_cts[i], k % unit.encoding_width());
-        });
-
-        return EncryptedRowVector(enc_mat_a.height(), unit, row_cts);
+        // scale and mask out first column
+        CKKSCiphertext result = eval.multiply_plain(unit_sum, col_mask);
+        // shift to the target column
+        eval.rotate_right_inplace(result, k % unit.encoding_width());
+        return result;
     }
 
-    /* Computes the k^th row of c*A*B given A^T and B, but NOT encoded as a vector.
-     * First, mask out the k^th column of A^T, which is the k^th row of A.
-     * The goal is to replicate this column to get the encoding of the k^th row of A (as columns)
-     * Returns a column vector with the same encoding unit as the inputs
+    /* Computes the j^th unit of the k^th row of c*A*B given the encoding of the k^th row of A and the j^th
+     * column of units of B, but NOT encoded as a vector: only the k^th row of the unit is non-zero.
+     * The result has the same encoding unit as the inputs.
      */
-    EncryptedColVector LinearAlgebra::matrix_matrix_mul_loop_row_major(const EncryptedMatrix &enc_mat_a_trans,
-                                                                       const EncryptedMatrix &enc_mat_b, double scalar,
-                                                                       int k, bool transpose_unit) {
-        EncryptedRowVector kth_row_A = extract_row(enc_mat_a_trans, k);
-        EncryptedColVector kth_row_A_times_B = multiply(kth_row_A, enc_mat_b);
-        rescale_to_next_inplace(kth_row_A_times_B);
-
-        // kth_row_A_times_B is a column vector encoded as rows.
+    CKKSCiphertext LinearAlgebra::matrix_matrix_mul_unit_row_major(const vector<CKKSCiphertext> &kth_row_a_cts,
+                                                                   const vector<CKKSCiphertext> &unit_col_b,
+                                                                   const EncodingUnit &unit, double scalar, int k,
+                                                                   bool transpose_unit) {
+        // This is the j^th unit of `multiply(kth_row_A, enc_mat_b)` followed by a rescale, but rather than
+        // computing the Hadamard product and summing the units in each column, we compute the sum of the
+        // products of the column of units with the vector directly. This requires only one
+        // relinearization per column of units, rather than one per unit.
+        CKKSCiphertext col_sum = eval.inner_product(kth_row_a_cts, unit_col_b);
+        // sum the rows of the unit, as in sum_rows_core
+        rot(col_sum, unit.encoding_height(), unit.encoding_width(), true);
+
+        // col_sum is a unit of a column vector encoded as rows.
         // we need to mask out the desired row (but NOT replicate it; we will add it to the other rows later)
 
-        int num_slots = enc_mat_a_trans.num_slots();
+        int num_slots = col_sum.num_slots();
 
-        // Currently, each row of kth_row_A_times_B is identical. We want to mask out one
+        // Currently, each row of col_sum is identical. We want to mask out one
         // so that we can add it to another row later to get our matrix product.
-        // Create a mask for the k^th row of kth_row_A_times_B.
+        // Create a mask for the k^th row of col_sum.
         // This mask is scaled by c so that we get a constant multiplication for free.
         vector<double> row_mask(num_slots);
 
         // both inputs have the same encoding unit
-        EncodingUnit mask_unit = enc_mat_b.encoding_unit();
+        EncodingUnit mask_unit = unit;
         if (transpose_unit) {
             // inputs have an n-by-m unit, we need to create a mask relative to an m-by-n unit
             mask_unit = mask_unit.transpose();
@@ -679,23 +729,46 @@ namespace hit {
         // row_in_unit is the row within the encoding unit that should contain the masked row
         int row_in_unit = k % mask_unit.encoding_height();
 
-        for (int i = 0; i < mask_unit.encoding_height(); i++) {
-            for (int j = 0; j < mask_unit.encoding_width(); j++) {
-                if ((transpose_unit && i == k && j < mask_unit.encoding_height()) ||
-                    (!transpose_unit && i == row_in_unit)) {
-                    row_mask[i * mask_unit.encoding_width() + j] = scalar;
+        for (int r = 0; r < mask_unit.encoding_height(); r++) {
+            for (int c = 0; c < mask_unit.encoding_width(); c++) {
+                if ((transpose_unit && r == k && c < mask_unit.encoding_height()) ||
+                    (!transpose_unit && r == row_in_unit)) {
+                    row_mask[r * mask_unit.encoding_width() + c] = scalar;
                 } else {
-                    row_mask[i * mask_unit.encoding_width() + j] = 0;
+                    row_mask[r * mask_unit.encoding_width() + c] = 0;
                 }
             }
         }
 
-        // iterate over all the (horizontally adjacent) units of this column vector to mask out the kth row
-        for (auto &ct : kth_row_A_times_B.cts) {
-            eval.multiply_plain_inplace(ct, row_mask);
-        }
+        eval.multiply_plain_inplace(col_sum, row_mask);
+        return col_sum;
+    }
 
-        return kth_row_A_times_B;
+    /* Sums each list of ciphertexts with a balanced tree of additions, leaving the sum in the first element
+     * of the list. Each level of the tree is a single parallel loop over the additions for all of the lists,
+     * so there is parallelism even when there are only a few long lists.
+     */
+    void LinearAlgebra::add_tree_inplace(vector<vector<CKKSCiphertext>> &summands) {
+        size_t max_terms = 0;
+        for (const auto &terms : summands) {
+            max_terms = max(max_terms, terms.size());
+        }
+        for (size_t stride = 1; stride < max_terms; stride *= 2) {
+            // at this level, term t of each list absorbs term t+stride, for each t which is a multiple of 2*stride
+            // first_addition[l] is the index of the first addition for list l
+            vector<int> first_addition(summands.size() + 1, 0);
+            for (size_t l = 0; l < summands.size(); l++) {
+                size_t num_terms = summands[l].size();
+                size_t num_additions = num_terms > stride ? (num_terms - stride + 2 * stride - 1) / (2 * stride) : 0;
+                first_addition[l + 1] = first_addition[l] + num_additions;
+            }
+            scheduler_.parallel_for_each(first_addition.back(), [&](int idx) {
+                // find the list containing this addition
+                size_t l = upper_bound(first_addition.begin(), first_addition.end(), idx) - first_addition.begin() - 1;
+                size_t t = 2 * stride * (idx - first_addition[l]);
+                eval.add_inplace(summands[l][t], summands[l][t + stride]);
+            });
+        }
     }
 
     void LinearAlgebra::matrix_multiply_validation(const EncryptedMatrix &enc_mat_a, const EncryptedMatrix &enc_mat_b,
@@ -733,42 +806,47 @@ namespace hit {
                                  << dim_string(enc_mat_a) + " vs " + dim_string(enc_mat_b_trans));
         }
 
-        // Multiply the matrix A by each column of B. The result is a list of EncryptedRowVectors, each with a single
-        // non-zero column. This function requires A to be at one level below enc_mat_b_trans.
-
-        // we will iterate over all rows of B^T (columns of B)
-        // and compute the k^th column of A times B
-        // then combine the results for each column to get the matrix product
-        vector<EncryptedRowVector> col_results(enc_mat_b_trans.height());
-
-        parallel_for(enc_mat_b_trans.height(), [&](int k) {
-            col_results[k] = matrix_matrix_mul_loop_col_major(enc_mat_a, enc_mat_b_trans, scalar, k);
-        });
-
-        // col_results[i] contains a *single* column (possibily distributed across several vertical cts)
-        // containing the i^th column of A times the matrix B
-        // The next step is to add unit.encoding_width of these together to make a single unit
+        // Multiply the matrix A by each column of B. The result for each column is a list of units, each with a
+        // single non-zero column. This function requires A to be at one level below enc_mat_b_trans.
+        // The columns of B are processed one column of units of the product at a time: the columns which make up
+        // the r^th column of units are extracted, multiplied by A, and summed before the next batch is extracted,
+        // so at most unit.encoding_width() extracted columns are held at once. Each step below is a single
+        // parallel loop over units (rather than over columns of B), so that products with few columns still use
+        // all of the scheduler's threads.
         EncodingUnit unit = enc_mat_a.encoding_unit();
-        int result_horizontal_units = ceil(enc_mat_b_trans.height() / static_cast<double>(unit.encoding_width()));
-        vector<vector<CKKSCiphertext>> matrix_cts(enc_mat_a.num_vertical_units());
-
-        // Proceed to append the individual column vectors one encoding unit row at a time
-        for (int i = 0; i < result_horizontal_units; i++) {
-            // this is the RowVector containing the first column of this vertical unit
-            EncryptedRowVector unit_col_i_cts = col_results[i * unit.encoding_width()];
-            for (int j = 1; j < unit.encoding_width(); j++) {
-                // there are exactly enc_mat_b_trans.height items in col_results, but this may not correspond
-                // to the number of columns in the encoding units (because some rows at the end may be 0-padding)
-                // thus, we need to break once we add all the ciphertexts in col_results
-                // this will break out of the inner loop, but the outer loop will immediately exit because
-                // the inner loop can only break when i = result_horizontal_units-1
-                if (i * unit.encoding_width() + j >= enc_mat_b_trans.height()) {
-                    break;
-                }
-                add_inplace(unit_col_i_cts, col_results[i * unit.encoding_width() + j]);
-            }
-            for (int j = 0; j < enc_mat_a.num_vertical_units(); j++) {
-                matrix_cts[j].push_back(unit_col_i_cts.cts[j]);
+        int num_cols = enc_mat_b_trans.height();
+        int num_b_units = enc_mat_b_trans.num_horizontal_units();
+        int num_a_units = enc_mat_a.num_vertical_units();
+        int result_horizontal_units = ceil(num_cols / static_cast<double>(unit.encoding_width()));
+        vector<vector<CKKSCiphertext>> matrix_cts(num_a_units, vector<CKKSCiphertext>(result_horizontal_units));
+        for (int r = 0; r < result_horizontal_units; r++) {
+            int first_col = r * unit.encoding_width();
+            // there are exactly enc_mat_b_trans.height columns, but this may not correspond to the number of
+            // columns in the encoding units (because some columns at the end may be 0-padding)
+            int batch_cols = min(unit.encoding_width(), num_cols - first_col);
+
+            // extract each unit of the rows of B^T (columns of B) in this batch
+            vector<vector<CKKSCiphertext>> cols_b(batch_cols, vector<CKKSCiphertext>(num_b_units));
+            scheduler_.parallel_for_each(batch_cols * num_b_units, [&](int idx) {
+                int k = first_col + idx / num_b_units;
+                int j = idx % num_b_units;
+                cols_b[k - first_col][j] =
+                    extract_col_unit(enc_mat_b_trans.cts[k / unit.encoding_height()][j], unit, k);
+            });
+
+            // summands[i][k - first_col] is the i^th unit of A times the k^th column of B
+            vector<vector<CKKSCiphertext>> summands(num_a_units, vector<CKKSCiphertext>(batch_cols));
+            scheduler_.parallel_for_each(batch_cols * num_a_units, [&](int idx) {
+                int k = first_col + idx / num_a_units;
+                int i = idx % num_a_units;
+                summands[i][k - first_col] =
+                    matrix_matrix_mul_unit_col_major(enc_mat_a.cts[i], cols_b[k - first_col], unit, scalar, k);
+            });
+            cols_b.clear();
+
+            add_tree_inplace(summands);
+            for (int i = 0; i < num_a_units; i++) {
+                matrix_cts[i][r] = move(summands[i][0]);
             }
         }
 
@@ -781,42 +859,58 @@ namespace hit {
                                                    bool transpose_unit) {
         // This function requires b to be at one level below enc_mat_a_trans.
 
-        // we will iterate over all columns of A^T (rows of A)
-        // and compute the k^th row of A times B
-        // then combine the results for each row to get the matrix product
-        vector<EncryptedColVector> row_results(enc_mat_a_trans.width());
-
-        parallel_for(enc_mat_a_trans.width(), [&](int k) {
-            row_results[k] = matrix_matrix_mul_loop_row_major(enc_mat_a_trans, enc_mat_b, scalar, k, transpose_unit);
-        });
-
-        // row_results[i] contains a *single* row (possibily distributed across several cts)
-        // containing the i^th row of A times the matrix B
-        // The next step is to add unit.encoding_height of these together to make a single unit
-        EncodingUnit unit = enc_mat_a_trans.encoding_unit();
+        // We compute the k^th row of A times B for each column of A^T (row of A),
+        // then combine the results for each row to get the matrix product.
+        // The rows of A are processed one row of units of the product at a time: the rows which make up the r^th
+        // row of units are extracted, multiplied by B, and summed before the next batch is extracted, so at most
+        // unit.encoding_height() extracted rows are held at once. Each step below is a single parallel loop over
+        // units (rather than over rows of A), so that products with few rows still use all of the scheduler's
+        // threads.
+        EncodingUnit input_unit = enc_mat_a_trans.encoding_unit();
+        EncodingUnit unit = input_unit;
 
         if (transpose_unit) {
             unit = unit.transpose();
         }
 
-        int result_vertical_units = ceil(enc_mat_a_trans.width() / static_cast<double>(unit.encoding_height()));
-        vector<vector<CKKSCiphertext>> matrix_cts(result_vertical_units);
-
-        for (int i = 0; i < result_vertical_units; i++) {
-            // this is the ColVector containing the first row of this horizontal unit
-            EncryptedColVector unit_row_i_cts = row_results[i * unit.encoding_height()];
-            for (int j = 1; j < unit.encoding_height(); j++) {
-                // there are exactly enc_mat_a_trans.width items in row_results, but this may not correspond
-                // to the number of rows in the encoding units (because some rows at the end may be 0-padding)
-                // thus, we need to break once we add all the ciphertexts in row_results
-                // this will break out of the inner loop, but the outer loop will immediately exit because
-                // the inner loop can only break when i = result_vertical_units-1
-                if (i * unit.encoding_height() + j >= enc_mat_a_trans.width()) {
-                    break;
+        int num_rows = enc_mat_a_trans.width();
+        int num_a_units = enc_mat_a_trans.num_vertical_units();
+        int num_b_units = enc_mat_b.num_horizontal_units();
+        int result_vertical_units = ceil(num_rows / static_cast<double>(unit.encoding_height()));
+        vector<vector<CKKSCiphertext>> matrix_cts(result_vertical_units, vector<CKKSCiphertext>(num_b_units));
+        for (int r = 0; r < result_vertical_units; r++) {
+            int first_row = r * unit.encoding_height();
+            // there are exactly enc_mat_a_trans.width rows, but this may not correspond to the number of
+            // rows in the encoding units (because some rows at the end may be 0-padding)
+            int batch_rows = min(unit.encoding_height(), num_rows - first_row);
+
+            // extract each unit of the columns of A^T (rows of A) in this batch
+            vector<vector<CKKSCiphertext>> rows_a(batch_rows, vector<CKKSCiphertext>(num_a_units));
+            scheduler_.parallel_for_each(batch_rows * num_a_units, [&](int idx) {
+                int k = first_row + idx / num_a_units;
+                int i = idx % num_a_units;
+                rows_a[k - first_row][i] =
+                    extract_row_unit(enc_mat_a_trans.cts[i][k / input_unit.encoding_width()], input_unit, k);
+            });
+
+            // summands[j][k - first_row] is the j^th unit of the k^th row of A times B
+            vector<vector<CKKSCiphertext>> summands(num_b_units, vector<CKKSCiphertext>(batch_rows));
+            scheduler_.parallel_for_each(batch_rows * num_b_units, [&](int idx) {
+                int k = first_row + idx / num_b_units;
+                int j = idx % num_b_units;
+                vector<CKKSCiphertext> unit_col_b(enc_mat_b.num_vertical_units());
+                for (int i = 0; i < enc_mat_b.num_vertical_units(); i++) {
+                    unit_col_b[i] = enc_mat_b.cts[i][j];
                 }
-                add_inplace(unit_row_i_cts, row_results[i * unit.encoding_height() + j]);
+                summands[j][k - first_row] = matrix_matrix_mul_unit_row_major(rows_a[k - first_row], unit_col_b,
+                                                                              input_unit, scalar, k, transpose_unit);
+            });
+            rows_a.clear();
+
+            add_tree_inplace(summands);
+            for (int j = 0; j < num_b_units; j++) {
+                matrix_cts[r][j] = move(summands[j][0]);
             }
-            matrix_cts[i] = unit_row_i_cts.cts;
         }
 
         return EncryptedMatrix(enc_mat_a_trans.width(), enc_mat_b.width(), unit, matrix_cts);
@@ -915,7 +1009,9 @@ namespace hit {
      * 1, and rotateLeft=false
      */
     void LinearAlgebra::rot(CKKSCiphertext &t1, int max, int stride, bool rotate_left) {
-        // serial implementation
+        // Each step rotates the running sum, so consecutive rotations act on different ciphertexts and cannot
+        // share a key-switching decomposition (see CKKSEvaluator::rotate_many). Every step is a power of two times
+        // `stride`, which has a key in the default key set.
         for (int i = 1; i < max; i <<= 1) {
             CKKSCiphertext t2;
             if (rotate_left) {
@@ -1006,7 +1102,7 @@ namespace hit {
 
         vector<CKKSCiphertext> cts(enc_mat.num_vertical_units());
 
-        parallel_for(enc_mat.num_vertical_units(), [&](int i) {
+        scheduler_.parallel_for_each(enc_mat.num_vertical_units(), [&](int i) {
             cts[i] = sum_cols_core(eval.add_many(enc_mat.cts[i]), enc_mat.encoding_unit(), scalar);
         });
 
@@ -1116,8 +1212,255 @@ namespace hit {
         }
         vector<CKKSCiphertext> cts(enc_mat.num_horizontal_units());
 
-        parallel_for(enc_mat.num_horizontal_units(), [&](int j) { cts[j] = sum_rows_core(enc_mat, j, false); });
+        scheduler_.parallel_for_each(enc_mat.num_horizontal_units(),
+                                     [&](int j) { cts[j] = sum_rows_core(enc_mat, j, false); });
 
         return EncryptedColVector(enc_mat.width(), enc_mat.encoding_unit(), cts);
     }
+
+    void LinearAlgebra::async_unit_validation(const CKKSCiphertext &ct, const string &api) {
+        if (ct.needs_relin()) {
+            LOG_AND_THROW_STREAM("Inputs to " + api + " must be linear ciphertexts");
+        }
+        if (ct.needs_rescale()) {
+            LOG_AND_THROW_STREAM("Inputs to " + api + " must have nominal scale");
+        }
+    }
+
+    Future<CKKSCiphertext> LinearAlgebra::add_tree_async(vector<Future<CKKSCiphertext>> terms) {
+        // at each level, term t absorbs term t+stride, as in add_tree_inplace
+        for (size_t stride = 1; stride < terms.size(); stride *= 2) {
+            for (size_t t = 0; t + stride < terms.size(); t += 2 * stride) {
+                terms[t] = scheduler_.submit<CKKSCiphertext>(
+                    [this](const CKKSCiphertext &a, const CKKSCiphertext &b) { return eval.add(a, b); }, terms[t],
+                    terms[t + stride]);
+            }
+        }
+        return terms[0];
+    }
+
+    AsyncEncrypted<EncryptedMatrix> LinearAlgebra::multiply_row_major_async(
+        const AsyncEncrypted<EncryptedMatrix> &enc_mat_a_trans, const AsyncEncrypted<EncryptedMatrix> &enc_mat_b,
+        double scalar) {
+        const EncryptedMatrix &a_trans_shape = enc_mat_a_trans.shape_;
+        const EncryptedMatrix &b_shape = enc_mat_b.shape_;
+        if (enc_mat_a_trans.units_.empty() || enc_mat_b.units_.empty()) {
+            LOG_AND_THROW_STREAM("Inputs to multiply_row_major_async are invalid; have they been initialized?");
+        }
+        if (a_trans_shape.encoding_unit() != b_shape.encoding_unit()) {
+            LOG_AND_THROW_STREAM("Inputs to multiply_row_major_async must have the same units: "
+                                 << dim_string(a_trans_shape.encoding_unit())
+                                 << "!=" << dim_string(b_shape.encoding_unit()));
+        }
+        if (a_trans_shape.height() != b_shape.height()) {
+            LOG_AND_THROW_STREAM("Inputs to multiply_row_major_async do not have compatible dimensions: "
+                                 << dim_string(a_trans_shape) + " vs " + dim_string(b_shape));
+        }
+
+        // This is multiply_common, but each extracted unit, product, and sum is a separate operation which
+        // starts as soon as the units it reads are ready. The rows of A are scheduled in order, so the products
+        // for the first rows run while later rows are still being extracted.
+        EncodingUnit unit = a_trans_shape.encoding_unit();
+        int num_rows = a_trans_shape.width();
+        int num_a_units = a_trans_shape.num_vertical_units();
+        int a_trans_horizontal_units = a_trans_shape.num_horizontal_units();
+        int num_b_units = b_shape.num_horizontal_units();
+        int result_vertical_units = ceil(num_rows / static_cast<double>(unit.encoding_height()));
+        // summands[r * num_b_units + j] holds the rows which make up the (r, j) unit of the product
+        vector<vector<Future<CKKSCiphertext>>> summands(result_vertical_units * num_b_units);
+        for (int k = 0; k < num_rows; k++) {
+            vector<Future<CKKSCiphertext>> row_a(num_a_units);
+            for (int i = 0; i < num_a_units; i++) {
+                row_a[i] = scheduler_.submit<CKKSCiphertext>(
+                    [this, unit, k](const CKKSCiphertext &a_trans_unit) {
+                        async_unit_validation(a_trans_unit, "multiply_row_major_async");
+                        return extract_row_unit(a_trans_unit, unit, k);
+                    },
+                    enc_mat_a_trans.units_[i * a_trans_horizontal_units + k / unit.encoding_width()]);
+            }
+            for (int j = 0; j < num_b_units; j++) {
+                // the k^th row of A, followed by the j^th column of units of B
+                vector<Future<CKKSCiphertext>> inputs(row_a);
+                for (int i = 0; i < num_a_units; i++) {
+                    inputs.push_back(enc_mat_b.units_[i * num_b_units + j]);
+                }
+                Future<CKKSCiphertext> product = scheduler_.submit_all<CKKSCiphertext>(
+                    [this, unit, scalar, k, num_a_units](const vector<const CKKSCiphertext *> &cts) {
+                        vector<CKKSCiphertext> kth_row_a(num_a_units);
+                        vector<CKKSCiphertext> unit_col_b(num_a_units);
+                        for (int i = 0; i < num_a_units; i++) {
+                            kth_row_a[i] = *cts[i];
+                            unit_col_b[i] = *cts[num_a_units + i];
+                            async_unit_validation(unit_col_b[i], "multiply_row_major_async");
+                        }
+                        if (unit_col_b[0].he_level() != kth_row_a[0].he_level()) {
+                            LOG_AND_THROW_STREAM(
+                                "Second argument to multiply_row_major_async must be one level below first argument: "
+                                << kth_row_a[0].he_level() + 1 << "!=" << unit_col_b[0].he_level() << "+1");
+                        }
+                        return matrix_matrix_mul_unit_row_major(kth_row_a, unit_col_b, unit, scalar, k, false);
+                    },
+                    move(inputs));
+                summands[(k / unit.encoding_height()) * num_b_units + j].push_back(product);
+            }
+        }
+
+        EncryptedMatrix shape;
+        shape.height_ = num_rows;
+        shape.width_ = b_shape.width();
+        shape.unit = unit;
+        shape.cts.assign(result_vertical_units, vector<CKKSCiphertext>(num_b_units));
+        vector<Future<CKKSCiphertext>> units;
+        units.reserve(summands.size());
+        for (auto &terms : summands) {
+            units.push_back(add_tree_async(move(terms)));
+        }
+        return AsyncEncrypted<EncryptedMatrix>(move(shape), move(units));
+    }
+
+    AsyncEncrypted<EncryptedMatrix> LinearAlgebra::multiply_col_major_async(
+        const AsyncEncrypted<EncryptedMatrix> &enc_mat_a, const AsyncEncrypted<EncryptedMatrix> &enc_mat_b_trans,
+        double scalar) {
+        const EncryptedMatrix &a_shape = enc_mat_a.shape_;
+        const EncryptedMatrix &b_trans_shape = enc_mat_b_trans.shape_;
+        if (enc_mat_a.units_.empty() || enc_mat_b_trans.units_.empty()) {
+            LOG_AND_THROW_STREAM("Inputs to multiply_col_major_async are invalid; have they been initialized?");
+        }
+        if (a_shape.encoding_unit() != b_trans_shape.encoding_unit()) {
+            LOG_AND_THROW_STREAM("Inputs to multiply_col_major_async must have the same units: "
+                                 << dim_string(a_shape.encoding_unit())
+                                 << "!=" << dim_string(b_trans_shape.encoding_unit()));
+        }
+        if (a_shape.width() != b_trans_shape.width()) {
+            LOG_AND_THROW_STREAM("Inputs to multiply_col_major_async do not have compatible dimensions: "
+                                 << dim_string(a_shape) + " vs " + dim_string(b_trans_shape));
+        }
+
+        // This is multiply_col_major, but each extracted unit, product, and sum is a separate operation which
+        // starts as soon as the units it reads are ready.
+        EncodingUnit unit = a_shape.encoding_unit();
+        int num_cols = b_trans_shape.height();
+        int num_a_units = a_shape.num_vertical_units();
+        int num_b_units = b_trans_shape.num_horizontal_units();
+        int result_horizontal_units = ceil(num_cols / static_cast<double>(unit.encoding_width()));
+        // summands[i * result_horizontal_units + r] holds the columns which make up the (i, r) unit of the product
+        vector<vector<Future<CKKSCiphertext>>> summands(num_a_units * result_horizontal_units);
+        for (int k = 0; k < num_cols; k++) {
+            vector<Future<CKKSCiphertext>> col_b(num_b_units);
+            for (int j = 0; j < num_b_units; j++) {
+                col_b[j] = scheduler_.submit<CKKSCiphertext>(
+                    [this, unit, k](const CKKSCiphertext &b_trans_unit) {
+                        async_unit_validation(b_trans_unit, "multiply_col_major_async");
+                        return extract_col_unit(b_trans_unit, unit, k);
+                    },
+                    enc_mat_b_trans.units_[(k / unit.encoding_height()) * num_b_units + j]);
+            }
+            for (int i = 0; i < num_a_units; i++) {
+                // the i^th row of units of A (which has the same width as B^T), followed by the k^th column of B
+                vector<Future<CKKSCiphertext>> inputs(enc_mat_a.units_.begin() + i * num_b_units,
+                                                      enc_mat_a.units_.begin() + (i + 1) * num_b_units);
+                inputs.insert(inputs.end(), col_b.begin(), col_b.end());
+                Future<CKKSCiphertext> product = scheduler_.submit_all<CKKSCiphertext>(
+                    [this, unit, scalar, k, num_b_units](const vector<const CKKSCiphertext *> &cts) {
+                        vector<CKKSCiphertext> unit_row_a(num_b_units);
+                        vector<CKKSCiphertext> kth_col_b(num_b_units);
+                        for (int j = 0; j < num_b_units; j++) {
+                            unit_row_a[j] = *cts[j];
+                            kth_col_b[j] = *cts[num_b_units + j];
+                            async_unit_validation(unit_row_a[j], "multiply_col_major_async");
+                        }
+                        if (unit_row_a[0].he_level() != kth_col_b[0].he_level()) {
+                            LOG_AND_THROW_STREAM(
+                                "First argument to multiply_col_major_async must be one level below second argument: "
+                                << unit_row_a[0].he_level() << "!=" << kth_col_b[0].he_level() + 1 << "+1");
+                        }
+                        return matrix_matrix_mul_unit_col_major(unit_row_a, kth_col_b, unit, scalar, k);
+                    },
+                    move(inputs));
+                summands[i * result_horizontal_units + k / unit.encoding_width()].push_back(product);
+            }
+        }
+
+        EncryptedMatrix shape;
+        shape.height_ = a_shape.height();
+        shape.width_ = num_cols;
+        shape.unit = unit;
+        shape.cts.assign(num_a_units, vector<CKKSCiphertext>(result_horizontal_units));
+        vector<Future<CKKSCiphertext>> units;
+        units.reserve(summands.size());
+        for (auto &terms : summands) {
+            units.push_back(add_tree_async(move(terms)));
+        }
+        return AsyncEncrypted<EncryptedMatrix>(move(shape), move(units));
+    }
+
+    AsyncEncrypted<EncryptedRowVector> LinearAlgebra::sum_cols_async(const AsyncEncrypted<EncryptedMatrix> &enc_mat,
+                                                                     double scalar) {
+        async_validation(enc_mat, enc_mat, "sum_cols_async");
+        EncodingUnit unit = enc_mat.shape_.encoding_unit();
+        int num_vertical_units = enc_mat.shape_.num_vertical_units();
+        int num_horizontal_units = enc_mat.shape_.num_horizontal_units();
+
+        // each unit of the output only depends on one row of units of the input
+        vector<Future<CKKSCiphertext>> units(num_vertical_units);
+        for (int i = 0; i < num_vertical_units; i++) {
+            vector<Future<CKKSCiphertext>> row(enc_mat.units_.begin() + i * num_horizontal_units,
+                                               enc_mat.units_.begin() + (i + 1) * num_horizontal_units);
+            units[i] = scheduler_.submit_all<CKKSCiphertext>(
+                [this, unit, scalar](const vector<const CKKSCiphertext *> &cts) {
+                    vector<CKKSCiphertext> row_cts;
+                    row_cts.reserve(cts.size());
+                    for (const CKKSCiphertext *ct : cts) {
+                        async_unit_validation(*ct, "sum_cols_async");
+                        row_cts.push_back(*ct);
+                    }
+                    return sum_cols_core(eval.add_many(row_cts), unit, scalar);
+                },
+                move(row));
+        }
+
+        EncryptedRowVector shape;
+        shape.width_ = enc_mat.shape_.height();
+        shape.unit = unit;
+        shape.cts.resize(num_vertical_units);
+        return AsyncEncrypted<EncryptedRowVector>(move(shape), move(units));
+    }
+
+    AsyncEncrypted<EncryptedColVector> LinearAlgebra::sum_rows_async(const AsyncEncrypted<EncryptedMatrix> &enc_mat) {
+        async_validation(enc_mat, enc_mat, "sum_rows_async");
+        EncodingUnit unit = enc_mat.shape_.encoding_unit();
+        int num_vertical_units = enc_mat.shape_.num_vertical_units();
+        int num_horizontal_units = enc_mat.shape_.num_horizontal_units();
+
+        // each unit of the output only depends on one column of units of the input
+        vector<Future<CKKSCiphertext>> units(num_horizontal_units);
+        for (int j = 0; j < num_horizontal_units; j++) {
+            vector<Future<CKKSCiphertext>> col;
+            for (int i = 0; i < num_vertical_units; i++) {
+                col.push_back(enc_mat.units_[i * num_horizontal_units + j]);
+            }
+            units[j] = scheduler_.submit_all<CKKSCiphertext>(
+                [this, unit](const vector<const CKKSCiphertext *> &cts) {
+                    vector<CKKSCiphertext> col_cts;
+                    col_cts.reserve(cts.size());
+                    for (const CKKSCiphertext *ct : cts) {
+                        if (ct->needs_relin()) {
+                            LOG_AND_THROW_STREAM("Input to sum_rows_async must be a linear ciphertext");
+                        }
+                        col_cts.push_back(*ct);
+                    }
+                    // as in sum_rows_core
+                    CKKSCiphertext output = eval.add_many(col_cts);
+                    rot(output, unit.encoding_height(), unit.encoding_width(), true);
+                    return output;
+                },
+                move(col));
+        }
+
+        EncryptedColVector shape;
+        shape.height_ = enc_mat.shape_.width();
+        shape.unit = unit;
+        shape.cts.resize(num_horizontal_units);
+        return AsyncEncrypted<EncryptedColVector>(move(shape), move(units));
+    }
 }  // namespace hit
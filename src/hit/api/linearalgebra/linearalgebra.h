@@ -5,12 +5,11 @@
 
 #include <glog/logging.h>
 
-#include <algorithm>
-#include <execution>
-
 #include "../../common.h"
+#include "../../scheduler.h"
 #include "../ciphertext.h"
 #include "../evaluator.h"
+#include "asyncencrypted.h"
 #include "encodingunit.h"
 #include "encryptedcolvector.h"
 #include "encryptedmatrix.h"
@@ -30,42 +29,22 @@
  * https://eprint.iacr.org/2020/1483 for more details.
  */
 
-/* Intended usage is:
- *
- *      parallel_for(x.size(), [&](int i) {
- *          foo1;
- *          foo2;
- *          ...
- *          foon;
- *      });
- */
-
-// https://stackoverflow.com/a/10379844/925978
-#define COMBINE1(X, Y) X##Y  // helper macro
-#define COMBINE(X, Y) COMBINE1(X, Y)
-
-#ifdef DISABLE_PARALLELISM
-#define UNIQUE_ID() COMBINE(i, __LINE__)
-#define parallel_for(max_idx, body)                                     \
-    for (int UNIQUE_ID() = 0; UNIQUE_ID() < (max_idx); UNIQUE_ID()++) { \
-        body(UNIQUE_ID());                                              \
-    }
-#else /* !DISABLE_PARALLELISM */
-// https://stackoverflow.com/a/17694752/925978
-#define parallel_for(max_idx, body)                                                     \
-    std::vector<int> COMBINE(iterIdxs, __LINE__)(max_idx);                              \
-    std::iota(begin(COMBINE(iterIdxs, __LINE__)), end(COMBINE(iterIdxs, __LINE__)), 0); \
-    std::for_each(__pstl::execution::par, begin(COMBINE(iterIdxs, __LINE__)), end(COMBINE(iterIdxs, __LINE__)), body)
-#endif /* DISABLE_PARALLELISM */
-
 namespace hit {
 
     // Evaluation and Encryption API for Linear Algebra objects
     class LinearAlgebra {
        public:
         /* Wraps a CKKSInstance to create a high-level API for linear algebra encoding, encryption, and operations
+         * Objects are encrypted with the evaluator's `encrypt_many`, so evaluator encryption settings (e.g.,
+         * `HomomorphicEval::set_symmetric_encryption`) also apply to the encryption functions below.
+         * Operations on the ciphertexts of an object run in parallel in a task arena owned by this instance,
+         * which uses at most `max_concurrency` threads (0 means one per hardware thread). This bounds the
+         * threads used by one instance when several run side by side.
          */
-        explicit LinearAlgebra(CKKSEvaluator &eval);
+        explicit LinearAlgebra(CKKSEvaluator &eval, int max_concurrency = 0);
+
+        // The scheduler for this instance, which can be used to run other loops in the same arena.
+        const TaskScheduler &scheduler() const;
 
         /* Creates a valid encoding unit for this instance, i.e., one which holds exactly as many
          * coefficients as there are plaintext slots.
@@ -782,7 +761,7 @@ namespace hit {
                                      << "Vector: " << arg1.needs_relin() << ", Matrix: " << arg2.needs_relin());
             }
 
-            parallel_for(arg1.num_cts(), [&](int i) { eval.multiply_inplace(arg1[i], arg2[i]); });
+            scheduler_.parallel_for_each(arg1.num_cts(), [&](int i) { eval.multiply_inplace(arg1[i], arg2[i]); });
         }
 
         /* Tranpose the encoding unit of a properly-encoded object.
@@ -881,7 +860,7 @@ namespace hit {
                 LOG_AND_THROW_STREAM("Input to hadamard_square must have nominal scale");
             }
 
-            parallel_for(arg.num_cts(), [&](int i) { eval.square_inplace(arg[i]); });
+            scheduler_.parallel_for_each(arg.num_cts(), [&](int i) { eval.square_inplace(arg[i]); });
         }
 
         /* Hadamard product of a row vector with each column of a matrix.
@@ -1071,7 +1050,7 @@ namespace hit {
         void reduce_level_to_inplace(T &arg, int level) {
             TRY_AND_THROW_STREAM(arg.validate(), "Argument to reduce_level_to is invalid; has it been initialized?");
 
-            parallel_for(arg.num_cts(), [&](int i) { eval.reduce_level_to_inplace(arg[i], level); });
+            scheduler_.parallel_for_each(arg.num_cts(), [&](int i) { eval.reduce_level_to_inplace(arg[i], level); });
         }
 
         /* Remove a prime from the modulus (i.e. go down one level) and scale
@@ -1097,7 +1076,7 @@ namespace hit {
         void rescale_to_next_inplace(T &arg) {
             TRY_AND_THROW_STREAM(arg.validate(), "Argument to rescale_to_next is invalid; has it been initialized?");
 
-            parallel_for(arg.num_cts(), [&](int i) { eval.rescale_to_next_inplace(arg[i]); });
+            scheduler_.parallel_for_each(arg.num_cts(), [&](int i) { eval.rescale_to_next_inplace(arg[i]); });
         }
 
         /* Ciphertexts in BGV-style encryption schemes, like CKKS, are polynomials
@@ -1122,25 +1101,111 @@ namespace hit {
             TRY_AND_THROW_STREAM(arg.validate(),
                                  "Argument to relinearize_inplace is invalid; has it been initialized?");
 
-            parallel_for(arg.num_cts(), [&](int i) { eval.relinearize_inplace(arg[i]); });
+            scheduler_.parallel_for_each(arg.num_cts(), [&](int i) { eval.relinearize_inplace(arg[i]); });
+        }
+
+        /* Asynchronous variants of the functions above, which take and return AsyncEncrypted objects. These
+         * functions check the dimensions and encoding units of their inputs and return immediately. Each unit of
+         * the output is computed by a separate operation in this instance's task arena, which starts as soon as
+         * the input units it depends on are ready. A chain of asynchronous operations therefore works on the
+         * units of its first result which are ready while the remaining units are still being computed, and
+         * independent operations (e.g., the heads of a layer) overlap. If the operation for a unit throws an
+         * exception (e.g., because the inputs are at different levels), the unit holds the exception, and so
+         * does every unit which depends on it. The destructor waits for all scheduled operations to finish.
+         */
+        template <typename T>
+        AsyncEncrypted<T> add_async(const AsyncEncrypted<T> &arg1, const AsyncEncrypted<T> &arg2) {
+            async_validation(arg1, arg2, "add_async");
+            return map_units_async(arg1, arg2,
+                                   [this](const CKKSCiphertext &a, const CKKSCiphertext &b) { return eval.add(a, b); });
+        }
+
+        template <typename T>
+        AsyncEncrypted<T> hadamard_multiply_async(const AsyncEncrypted<T> &arg1, const AsyncEncrypted<T> &arg2) {
+            async_validation(arg1, arg2, "hadamard_multiply_async");
+            return map_units_async(arg1, arg2, [this](const CKKSCiphertext &a, const CKKSCiphertext &b) {
+                async_unit_validation(a, "hadamard_multiply_async");
+                async_unit_validation(b, "hadamard_multiply_async");
+                return eval.multiply(a, b);
+            });
         }
 
+        template <typename T>
+        AsyncEncrypted<T> rescale_to_next_async(const AsyncEncrypted<T> &arg) {
+            async_validation(arg, arg, "rescale_to_next_async");
+            std::vector<Future<CKKSCiphertext>> units(arg.units_.size());
+            for (size_t i = 0; i < units.size(); i++) {
+                units[i] = scheduler_.submit<CKKSCiphertext>(
+                    [this](const CKKSCiphertext &ct) { return eval.rescale_to_next(ct); }, arg.units_[i]);
+            }
+            return AsyncEncrypted<T>(arg.shape_, std::move(units));
+        }
+
+        AsyncEncrypted<EncryptedMatrix> multiply_row_major_async(const AsyncEncrypted<EncryptedMatrix> &enc_mat_a_trans,
+                                                                 const AsyncEncrypted<EncryptedMatrix> &enc_mat_b,
+                                                                 double scalar = 1);
+
+        AsyncEncrypted<EncryptedMatrix> multiply_col_major_async(const AsyncEncrypted<EncryptedMatrix> &enc_mat_a,
+                                                                 const AsyncEncrypted<EncryptedMatrix> &enc_mat_b_trans,
+                                                                 double scalar = 1);
+
+        AsyncEncrypted<EncryptedRowVector> sum_cols_async(const AsyncEncrypted<EncryptedMatrix> &enc_mat,
+                                                          double scalar = 1);
+
+        AsyncEncrypted<EncryptedColVector> sum_rows_async(const AsyncEncrypted<EncryptedMatrix> &enc_mat);
+
+        // Block until every operation scheduled by an asynchronous function has finished.
+        void wait();
+
         CKKSEvaluator &eval;
 
        private:
+        TaskScheduler scheduler_;
+
+        // checks that the inputs to an asynchronous operation are initialized and have the same size
+        template <typename T>
+        void async_validation(const AsyncEncrypted<T> &arg1, const AsyncEncrypted<T> &arg2, const std::string &api) {
+            if (arg1.units_.empty() || arg2.units_.empty()) {
+                LOG_AND_THROW_STREAM("Inputs to " + api + " are invalid; have they been initialized?");
+            }
+            if (!arg1.shape_.same_size(arg2.shape_)) {
+                LOG_AND_THROW_STREAM("Dimension mismatch in " + api + ": " + dim_string(arg1.shape_)
+                                     << " vs " + dim_string(arg2.shape_));
+            }
+        }
+
+        // checks that one unit of an input to an asynchronous operation is linear and has nominal scale
+        static void async_unit_validation(const CKKSCiphertext &ct, const std::string &api);
+
+        // computes each unit of the output by applying `op` to the corresponding units of `arg1` and `arg2`
+        template <typename T, typename F>
+        AsyncEncrypted<T> map_units_async(const AsyncEncrypted<T> &arg1, const AsyncEncrypted<T> &arg2, F op) {
+            std::vector<Future<CKKSCiphertext>> units(arg1.units_.size());
+            for (size_t i = 0; i < units.size(); i++) {
+                units[i] = scheduler_.submit<CKKSCiphertext>(op, arg1.units_[i], arg2.units_[i]);
+            }
+            return AsyncEncrypted<T>(arg1.shape_, std::move(units));
+        }
+
+        // sums `terms` with a balanced tree of asynchronous additions
+        Future<CKKSCiphertext> add_tree_async(std::vector<Future<CKKSCiphertext>> terms);
+
         template <typename T>
         std::string dim_string(const T &arg);
         EncryptedMatrix encrypt_matrix_internal(
             const Matrix &mat, const EncodingUnit &unit,
-            std::function<CKKSCiphertext(CKKSEvaluator &, const std::vector<double> &)> encrypt);
+            std::function<std::vector<CKKSCiphertext>(CKKSEvaluator &, const std::vector<std::vector<double>> &)>
+                encrypt_many);
 
         EncryptedRowVector encrypt_row_vector_internal(
             const Vector &vec, const EncodingUnit &unit,
-            std::function<CKKSCiphertext(CKKSEvaluator &, const std::vector<double> &)> encrypt);
+            std::function<std::vector<CKKSCiphertext>(CKKSEvaluator &, const std::vector<std::vector<double>> &)>
+                encrypt_many);
 
         EncryptedColVector encrypt_col_vector_internal(
             const Vector &vec, const EncodingUnit &unit,
-            std::function<CKKSCiphertext(CKKSEvaluator &, const std::vector<double> &)> encrypt);
+            std::function<std::vector<CKKSCiphertext>(CKKSEvaluator &, const std::vector<std::vector<double>> &)>
+                encrypt_many);
 
         // helper function for validating inputs to matrix-matrix multiplication
         void matrix_multiply_validation(const EncryptedMatrix &enc_mat_a, const EncryptedMatrix &enc_mat_b,
@@ -1187,30 +1252,43 @@ namespace hit {
          */
         CKKSCiphertext sum_rows_core(const EncryptedMatrix &enc_mat, int j, bool transpose_unit);
 
+        // input validation for hadamard_multiply(const EncryptedMatrix&, const EncryptedColVector&), which is
+        // shared with multiply(const EncryptedMatrix&, const EncryptedColVector&, double)
+        void hadamard_multiply_validation(const EncryptedMatrix &enc_mat, const EncryptedColVector &enc_vec);
+
         // helper function for sum_rows and sum_cols which repeatedly shifts by increasing powers of two, adding the
         // results
         void rot(CKKSCiphertext &t1, int max, int stride, bool rotate_left);
 
-        // inner loop for multiply_row_major
-        EncryptedColVector matrix_matrix_mul_loop_row_major(const EncryptedMatrix &enc_mat_a_trans,
-                                                            const EncryptedMatrix &enc_mat_b, double scalar, int k,
-                                                            bool transpose_unit);
+        // computes one unit of one row of the product for multiply_row_major, given the k^th row of A and
+        // one column of units of B, which are encoded with `unit`
+        CKKSCiphertext matrix_matrix_mul_unit_row_major(const std::vector<CKKSCiphertext> &kth_row_a_cts,
+                                                        const std::vector<CKKSCiphertext> &unit_col_b,
+                                                        const EncodingUnit &unit, double scalar, int k,
+                                                        bool transpose_unit);
 
-        // inner loop for multiply_col_major
-        EncryptedRowVector matrix_matrix_mul_loop_col_major(const EncryptedMatrix &enc_mat_a,
-                                                            const EncryptedMatrix &enc_mat_b_trans, double scalar,
-                                                            int k);
+        // computes one unit of one column of the product for multiply_col_major, given one row of units of A
+        // and the k^th column of B, which are encoded with `unit`
+        CKKSCiphertext matrix_matrix_mul_unit_col_major(const std::vector<CKKSCiphertext> &unit_row_a,
+                                                        const std::vector<CKKSCiphertext> &kth_col_b_cts,
+                                                        const EncodingUnit &unit, double scalar, int k);
 
         // common core for matrix/matrix multiplication; used by both multiply_row_major and
         // multiply_row_major_mixed_unit
         EncryptedMatrix multiply_common(const EncryptedMatrix &enc_mat_a_trans, const EncryptedMatrix &enc_mat_b,
                                         double scalar, bool transpose_unit);
 
-        // helper function for multiply_row_major which extracts a single row of A given the encoding of A^T
-        EncryptedRowVector extract_row(const EncryptedMatrix &enc_mat_a_trans, int row);
+        // helper function for multiply_row_major which extracts one unit of a single row of A given the unit
+        // of A^T which contains it (i.e., the unit in column `row / unit.encoding_width()`)
+        CKKSCiphertext extract_row_unit(const CKKSCiphertext &a_trans_unit, const EncodingUnit &unit, int row);
+
+        // helper function for multiply_col_major which extracts one unit of a single column of B given the unit
+        // of B^T which contains it (i.e., the unit in row `col / unit.encoding_height()`)
+        CKKSCiphertext extract_col_unit(const CKKSCiphertext &b_trans_unit, const EncodingUnit &unit, int col);
 
-        // helper function for multiply_col_major which extracts a single column of B given the encoding of B^T
-        EncryptedColVector extract_col(const EncryptedMatrix &enc_mat_b_trans, int col);
+        // helper function for matrix/matrix multiplication which sums each list of ciphertexts in parallel,
+        // leaving the sum in the first element of the list
+        void add_tree_inplace(std::vector<std::vector<CKKSCiphertext>> &summands);
     };
 
 }  // namespace hit
@@ -0,0 +1,134 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "plaintextcache.h"
+
+#include <cstring>
+
+using namespace std;
+using namespace seal;
+
+namespace hit {
+
+    namespace {
+        // 64-bit FNV-1a
+        const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+        const uint64_t FNV_PRIME = 1099511628211ULL;
+
+        uint64_t fnv1a(const void *data, size_t num_bytes, uint64_t hash = FNV_OFFSET_BASIS) {
+            const auto *bytes = static_cast<const unsigned char *>(data);
+            for (size_t i = 0; i < num_bytes; i++) {
+                hash ^= bytes[i];
+                hash *= FNV_PRIME;
+            }
+            return hash;
+        }
+    }  // namespace
+
+    bool PlaintextCache::Key::operator==(const Key &other) const {
+        // Scales are compared bitwise: the scale of a ciphertext is computed deterministically,
+        // so equal scales have identical representations.
+        return content_hash == other.content_hash && parms_id == other.parms_id &&
+               memcmp(&scale, &other.scale, sizeof(double)) == 0;
+    }
+
+    size_t PlaintextCache::KeyHash::operator()(const Key &key) const {
+        uint64_t hash = fnv1a(key.parms_id.data(), key.parms_id.size() * sizeof(uint64_t), key.content_hash);
+        return static_cast<size_t>(fnv1a(&key.scale, sizeof(double), hash));
+    }
+
+    PlaintextCache::PlaintextCache(size_t max_bytes) : max_bytes_(max_bytes) {
+    }
+
+    PlaintextCache::Key PlaintextCache::make_key(const vector<double> &values, const parms_id_type &parms_id,
+                                                 double scale) {
+        return Key{fnv1a(values.data(), values.size() * sizeof(double)), parms_id, scale};
+    }
+
+    shared_ptr<const Plaintext> PlaintextCache::lookup(const vector<double> &values, const parms_id_type &parms_id,
+                                                       double scale) {
+        if (!enabled()) {
+            return nullptr;
+        }
+        // hash outside of the lock
+        Key key = make_key(values, parms_id, scale);
+
+        scoped_lock lock(mutex_);
+        auto it = index_.find(key);
+        if (it == index_.end() || it->second->values != values) {
+            misses_++;
+            return nullptr;
+        }
+        hits_++;
+        // move this entry to the front of the LRU list
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return it->second->plaintext;
+    }
+
+    void PlaintextCache::insert(const vector<double> &values, const parms_id_type &parms_id, double scale,
+                                shared_ptr<const Plaintext> plaintext) {
+        if (!enabled()) {
+            return;
+        }
+        size_t entry_bytes = plaintext->coeff_count() * sizeof(uint64_t) + values.size() * sizeof(double);
+        Key key = make_key(values, parms_id, scale);
+
+        scoped_lock lock(mutex_);
+        if (entry_bytes > max_bytes_) {
+            return;
+        }
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            // Another thread encoded the same plaintext concurrently, or this is a hash collision.
+            // Either way, the newest entry replaces the existing one.
+            size_bytes_ -= it->second->size_bytes;
+            entries_.erase(it->second);
+            index_.erase(it);
+        }
+        evict_to(max_bytes_ - entry_bytes);
+        entries_.push_front(Entry{key, values, move(plaintext), entry_bytes});
+        index_[key] = entries_.begin();
+        size_bytes_ += entry_bytes;
+    }
+
+    // must be called with the lock held
+    void PlaintextCache::evict_to(size_t max_bytes) {
+        while (size_bytes_ > max_bytes && !entries_.empty()) {
+            const Entry &lru = entries_.back();
+            size_bytes_ -= lru.size_bytes;
+            index_.erase(lru.key);
+            entries_.pop_back();
+            evictions_++;
+        }
+    }
+
+    bool PlaintextCache::enabled() const {
+        scoped_lock lock(mutex_);
+        return max_bytes_ > 0;
+    }
+
+    void PlaintextCache::set_max_bytes(size_t max_bytes) {
+        scoped_lock lock(mutex_);
+        max_bytes_ = max_bytes;
+        evict_to(max_bytes_);
+    }
+
+    void PlaintextCache::clear() {
+        scoped_lock lock(mutex_);
+        entries_.clear();
+        index_.clear();
+        size_bytes_ = 0;
+    }
+
+    PlaintextCacheStats PlaintextCache::stats() const {
+        scoped_lock lock(mutex_);
+        PlaintextCacheStats result;
+        result.hits = hits_;
+        result.misses = misses_;
+        result.evictions = evictions_;
+        result.entries = entries_.size();
+        result.size_bytes = size_bytes_;
+        result.max_bytes = max_bytes_;
+        return result;
+    }
+}  // namespace hit
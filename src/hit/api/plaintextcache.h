@@ -0,0 +1,100 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "seal/seal.h"
+
+// Default memory limit for the encoded plaintext cache (256 MiB)
+#define DEFAULT_PLAINTEXT_CACHE_BYTES (256ULL << 20)
+
+namespace hit {
+
+    struct PlaintextCacheStats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t entries = 0;
+        size_t size_bytes = 0;
+        size_t max_bytes = 0;
+    };
+
+    /* An internal API for the HE backend.
+     * Encoding a plaintext vector is expensive: it requires an inverse FFT followed by
+     * an NTT for each prime in the modulus. Many circuits (in particular, the masks used by
+     * LinearAlgebra) encode the same public vector at the same level and scale over and over.
+     * This is a bounded, thread-safe, least-recently-used cache of encoded plaintexts, keyed
+     * by the plaintext contents, the SEAL parms_id (i.e., level), and the encoding scale.
+     *
+     * Entries are handed out as shared pointers, so an entry which is evicted while another
+     * thread is still using it remains valid until that thread is done with it.
+     * A cache with a memory limit of 0 bytes is disabled: lookups always miss and
+     * inserts are ignored, and neither is counted in the statistics.
+     */
+    class PlaintextCache {
+       public:
+        explicit PlaintextCache(size_t max_bytes = DEFAULT_PLAINTEXT_CACHE_BYTES);
+
+        // Returns the cached encoding of `values` at `parms_id` and `scale`, or nullptr if there is none.
+        std::shared_ptr<const seal::Plaintext> lookup(const std::vector<double> &values,
+                                                      const seal::parms_id_type &parms_id, double scale);
+
+        // Add an encoding of `values` at `parms_id` and `scale` to the cache, evicting least-recently
+        // used entries as necessary to stay within the memory limit. Plaintexts which are larger
+        // than the memory limit are not cached.
+        void insert(const std::vector<double> &values, const seal::parms_id_type &parms_id, double scale,
+                    std::shared_ptr<const seal::Plaintext> plaintext);
+
+        bool enabled() const;
+
+        // Change the memory limit; shrinking the limit evicts entries immediately.
+        void set_max_bytes(size_t max_bytes);
+
+        // Remove all entries. Statistics are not reset.
+        void clear();
+
+        PlaintextCacheStats stats() const;
+
+       private:
+        struct Key {
+            uint64_t content_hash;
+            seal::parms_id_type parms_id;
+            double scale;
+
+            bool operator==(const Key &other) const;
+        };
+
+        struct KeyHash {
+            size_t operator()(const Key &key) const;
+        };
+
+        struct Entry {
+            Key key;
+            // The encoded values are stored alongside the plaintext so that a
+            // hash collision can never return the wrong encoding.
+            std::vector<double> values;
+            std::shared_ptr<const seal::Plaintext> plaintext;
+            size_t size_bytes;
+        };
+
+        static Key make_key(const std::vector<double> &values, const seal::parms_id_type &parms_id, double scale);
+        void evict_to(size_t max_bytes);
+
+        // most recently used entries are at the front of the list
+        std::list<Entry> entries_;
+        std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index_;
+        size_t max_bytes_;
+        size_t size_bytes_ = 0;
+        uint64_t hits_ = 0;
+        uint64_t misses_ = 0;
+        uint64_t evictions_ = 0;
+        mutable std::mutex mutex_;
+    };
+}  // namespace hit
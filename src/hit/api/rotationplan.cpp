@@ -0,0 +1,178 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "rotationplan.h"
+
+#include <algorithm>
+#include <set>
+#include <utility>
+
+#include "../common.h"
+#include "context.h"
+
+using namespace std;
+
+namespace hit {
+
+    namespace {
+        // Shortest sequences of key rotations from the identity to each rotation in Z_{num_slots}
+        struct KeySearch {
+            // the number of rotations needed to reach each residue, or -1 if it is unreachable
+            vector<int> distance;
+            // the key used for the last rotation on a shortest path to each residue
+            vector<int> last_key;
+        };
+
+        // Breadth-first search of the rotations reachable with `keys`, which stops once every target is reached.
+        KeySearch search_keys(const vector<int> &keys, const vector<bool> &is_target, size_t num_targets) {
+            int num_slots = is_target.size();
+            KeySearch result{vector<int>(num_slots, -1), vector<int>(num_slots, -1)};
+            result.distance[0] = 0;
+            vector<int> queue{0};
+            size_t remaining = num_targets;
+            for (size_t head = 0; head < queue.size() && remaining > 0; head++) {
+                int residue = queue[head];
+                for (int key : keys) {
+                    int next = (residue + key) % num_slots;
+                    if (result.distance[next] < 0) {
+                        result.distance[next] = result.distance[residue] + 1;
+                        result.last_key[next] = key;
+                        queue.push_back(next);
+                        if (is_target[next]) {
+                            remaining--;
+                        }
+                    }
+                }
+            }
+            return result;
+        }
+
+        // The number of unreachable targets and the predicted cost of the extra rotations, ordered lexicographically
+        pair<size_t, double> plan_cost(const KeySearch &search, const vector<int> &targets,
+                                       const vector<double> &target_costs) {
+            pair<size_t, double> cost(0, 0);
+            for (size_t i = 0; i < targets.size(); i++) {
+                int distance = search.distance[targets[i]];
+                if (distance < 0) {
+                    cost.first++;
+                } else {
+                    cost.second += target_costs[i] * (distance - 1);
+                }
+            }
+            return cost;
+        }
+
+        int to_residue(int step, int num_slots) {
+            return ((step % num_slots) + num_slots) % num_slots;
+        }
+
+        // The step in (-num_slots/2, num_slots/2] which rotates by `residue`
+        int to_step(int residue, int num_slots) {
+            return residue > num_slots / 2 ? residue - num_slots : residue;
+        }
+
+        double rotation_cost(int level) {
+            return static_cast<double>(level + 1) * (level + 2);
+        }
+    }  // namespace
+
+    RotationKeyPlan plan_rotation_keys(const vector<RotationCount> &rotations, int num_slots, int max_ct_level,
+                                       uint64_t key_budget_bytes) {
+        if (!is_pow2(num_slots)) {
+            LOG_AND_THROW_STREAM("num_slots must be a power of 2; got " << num_slots);
+        }
+        if (max_ct_level < 0) {
+            LOG_AND_THROW_STREAM("max_ct_level must be non-negative; got " << max_ct_level);
+        }
+
+        // Rotations by a multiple of num_slots are the identity, and cost nothing.
+        map<int, double> residue_costs;
+        for (const auto &rotation : rotations) {
+            if (rotation.level < 0 || rotation.level > max_ct_level) {
+                LOG_AND_THROW_STREAM("Invalid level for a rotation: " << rotation.level << "; max_ct_level is "
+                                                                       << max_ct_level);
+            }
+            int residue = to_residue(rotation.step, num_slots);
+            if (residue != 0) {
+                residue_costs[residue] += rotation.count * rotation_cost(rotation.level);
+            }
+        }
+        vector<int> targets;
+        vector<double> target_costs;
+        vector<bool> is_target(num_slots, false);
+        for (const auto &entry : residue_costs) {
+            targets.push_back(entry.first);
+            target_costs.push_back(entry.second);
+            is_target[entry.first] = true;
+        }
+
+        uint64_t key_bytes =
+            estimate_key_size(1, num_slots, max_ct_level) - estimate_key_size(0, num_slots, max_ct_level);
+        uint64_t max_keys = key_budget_bytes / key_bytes;
+        if (max_keys == 0 && !targets.empty()) {
+            LOG_AND_THROW_STREAM("A rotation key budget of " << key_budget_bytes << " bytes is too small for a single "
+                                                             << key_bytes << "-byte key");
+        }
+
+        vector<int> keys;
+        if (max_keys >= targets.size()) {
+            keys = targets;
+        } else {
+            // Greedily add the key which most reduces the cost. Candidates are the recorded steps,
+            // and powers of two in both directions; rotating by 1 reaches every step, so the first key
+            // chosen makes every step reachable.
+            set<int> candidates(targets.begin(), targets.end());
+            for (int power = 1; power < num_slots; power *= 2) {
+                candidates.insert(power);
+                candidates.insert(num_slots - power);
+            }
+            pair<size_t, double> best_cost(targets.size(), 0);
+            while (keys.size() < max_keys) {
+                int best_candidate = -1;
+                for (int candidate : candidates) {
+                    keys.push_back(candidate);
+                    pair<size_t, double> cost =
+                        plan_cost(search_keys(keys, is_target, targets.size()), targets, target_costs);
+                    keys.pop_back();
+                    if (cost < best_cost) {
+                        best_cost = cost;
+                        best_candidate = candidate;
+                    }
+                }
+                if (best_candidate < 0) {
+                    break;
+                }
+                keys.push_back(best_candidate);
+                candidates.erase(best_candidate);
+            }
+        }
+
+        RotationKeyPlan plan;
+        for (int key : keys) {
+            plan.key_steps.push_back(to_step(key, num_slots));
+        }
+        sort(plan.key_steps.begin(), plan.key_steps.end());
+
+        KeySearch search = search_keys(keys, is_target, targets.size());
+        for (const auto &rotation : rotations) {
+            int residue = to_residue(rotation.step, num_slots);
+            if (residue == 0) {
+                continue;
+            }
+            int distance = search.distance[residue];
+            double cost = rotation.count * rotation_cost(rotation.level);
+            plan.rotation_cost += cost;
+            plan.extra_rotations += rotation.count * (distance - 1);
+            plan.extra_rotation_cost += cost * (distance - 1);
+            if (distance > 1 && plan.decompositions.count(rotation.step) == 0) {
+                vector<int> &decomposition = plan.decompositions[rotation.step];
+                while (residue != 0) {
+                    int key = search.last_key[residue];
+                    decomposition.push_back(to_step(key, num_slots));
+                    residue = to_residue(residue - key, num_slots);
+                }
+            }
+        }
+        return plan;
+    }
+}  // namespace hit
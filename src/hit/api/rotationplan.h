@@ -0,0 +1,49 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace hit {
+
+    // The number of times a circuit rotates by `step` (left rotations are positive) at ciphertext level `level`
+    struct RotationCount {
+        int step;
+        int level;
+        uint64_t count;
+    };
+
+    /* A set of rotation keys, and a table describing how to compose each rotation which does not
+     * have its own key from the keys in the set.
+     *
+     * Costs are predicted with a simple model: a rotation at level `l` costs (l+1)*(l+2), which is
+     * proportional to the number of polynomial products in key switching.
+     */
+    struct RotationKeyPlan {
+        // Steps to generate keys for; suitable for the `galois_steps` argument of the HomomorphicEval constructor
+        std::vector<int> key_steps;
+        // For each recorded step without its own key, the key steps whose composition is a rotation by that step
+        std::map<int, std::vector<int>> decompositions;
+        // The cost of the recorded rotations when every step has its own key
+        double rotation_cost = 0;
+        // The number and cost of the additional rotations needed to compose steps from `key_steps`
+        uint64_t extra_rotations = 0;
+        double extra_rotation_cost = 0;
+    };
+
+    /* Choose at most `key_budget_bytes` worth of rotation keys for a circuit which performs `rotations`
+     * (see RotationSet::rotation_counts) on ciphertexts with `num_slots` slots, with keys for a maximum
+     * ciphertext level of `max_ct_level`. If every recorded step fits in the budget, each step gets its
+     * own key. Otherwise, keys are chosen greedily (from the recorded steps and powers of two) to minimize
+     * the predicted cost of composing the remaining steps, and each step is composed along a shortest
+     * sequence of keys. This throws an exception if the budget does not allow a single key.
+     *
+     * Planning runs a breadth-first search over all `num_slots` rotations for each candidate key set, so it is
+     * intended to be run offline, once per circuit.
+     */
+    RotationKeyPlan plan_rotation_keys(const std::vector<RotationCount> &rotations, int num_slots, int max_ct_level,
+                                       uint64_t key_budget_bytes);
+}  // namespace hit
@@ -0,0 +1,161 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "zeroencryptionpool.h"
+
+#include "../common.h"
+
+using namespace std;
+using namespace seal;
+
+namespace hit {
+
+    ZeroEncryptionPool::ZeroEncryptionPool(const ZeroEncryptionPoolConfig &config, int max_level, Generator generate)
+        : depth_(config.depth), refill_threshold_(config.refill_threshold), generate_(move(generate)) {
+        if (config.num_threads <= 0) {
+            LOG_AND_THROW_STREAM("The zero encryption pool requires at least one background thread, got "
+                                 << config.num_threads);
+        }
+        if (config.depth == 0 || config.refill_threshold > config.depth) {
+            LOG_AND_THROW_STREAM("Invalid zero encryption pool depth: the depth must be positive and at least "
+                                 << "the refill threshold, got depth " << config.depth << " and threshold "
+                                 << config.refill_threshold);
+        }
+        if (config.levels.empty()) {
+            pools_[max_level];
+        }
+        for (int level : config.levels) {
+            if (level < 0 || level > max_level) {
+                LOG_AND_THROW_STREAM("Levels in the zero encryption pool must be between 0 and " << max_level
+                                                                                               << ", got " << level);
+            }
+            pools_[level];
+        }
+
+        for (int i = 0; i < config.num_threads; i++) {
+            workers_.emplace_back([this]() { worker_loop(); });
+        }
+    }
+
+    ZeroEncryptionPool::~ZeroEncryptionPool() {
+        {
+            scoped_lock lock(mutex_);
+            stop_ = true;
+        }
+        refill_cv_.notify_all();
+        filled_cv_.notify_all();
+        for (auto &worker : workers_) {
+            worker.join();
+        }
+    }
+
+    bool ZeroEncryptionPool::take(int level, Ciphertext &destination) {
+        scoped_lock lock(mutex_);
+        auto it = pools_.find(level);
+        if (it == pools_.end() || it->second.cts.empty()) {
+            misses_++;
+            return false;
+        }
+        LevelPool &pool = it->second;
+        destination = move(pool.cts.front());
+        pool.cts.pop_front();
+        hits_++;
+        if (!pool.refilling && pool.error == nullptr && pool.cts.size() < refill_threshold_) {
+            pool.refilling = true;
+            refill_cv_.notify_all();
+        }
+        return true;
+    }
+
+    void ZeroEncryptionPool::fill() {
+        unique_lock lock(mutex_);
+        for (auto &[level, pool] : pools_) {
+            pool.refilling = true;
+            pool.error = nullptr;
+        }
+        refill_cv_.notify_all();
+        filled_cv_.wait(lock, [this]() {
+            if (stop_) {
+                return true;
+            }
+            for (const auto &[level, pool] : pools_) {
+                // a level which failed is done once its other in-flight encryptions are
+                bool failed = pool.error != nullptr && pool.in_flight == 0;
+                if (pool.cts.size() < depth_ && !failed) {
+                    return false;
+                }
+            }
+            return true;
+        });
+        for (const auto &[level, pool] : pools_) {
+            if (pool.error != nullptr && !stop_) {
+                rethrow_exception(pool.error);
+            }
+        }
+    }
+
+    ZeroEncryptionPoolStats ZeroEncryptionPool::stats() const {
+        scoped_lock lock(mutex_);
+        ZeroEncryptionPoolStats result;
+        result.hits = hits_;
+        result.misses = misses_;
+        result.generated = generated_;
+        for (const auto &[level, pool] : pools_) {
+            result.available[level] = pool.cts.size();
+        }
+        return result;
+    }
+
+    int ZeroEncryptionPool::next_level_to_refill() {
+        for (auto &[level, pool] : pools_) {
+            if (!pool.refilling) {
+                continue;
+            }
+            if (pool.cts.size() + pool.in_flight < depth_) {
+                return level;
+            }
+            // the level will be full once the in-flight encryptions are done
+            pool.refilling = false;
+        }
+        return -1;
+    }
+
+    void ZeroEncryptionPool::worker_loop() {
+        unique_lock lock(mutex_);
+        while (true) {
+            int level = -1;
+            refill_cv_.wait(lock, [&]() {
+                if (stop_) {
+                    return true;
+                }
+                level = next_level_to_refill();
+                return level >= 0;
+            });
+            if (stop_) {
+                return;
+            }
+
+            LevelPool &pool = pools_[level];
+            pool.in_flight++;
+            lock.unlock();
+            Ciphertext ct;
+            exception_ptr error;
+            try {
+                generate_(level, ct);
+            } catch (...) {
+                // an exception must not escape the thread; stop refilling the level until `fill` retries it
+                error = current_exception();
+            }
+            lock.lock();
+            pool.in_flight--;
+            if (error == nullptr) {
+                pool.cts.push_back(move(ct));
+                generated_++;
+            } else {
+                pool.error = error;
+                pool.refilling = false;
+            }
+            filled_cv_.notify_all();
+        }
+    }
+}  // namespace hit
@@ -0,0 +1,111 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "seal/seal.h"
+
+namespace hit {
+
+    struct ZeroEncryptionPoolConfig {
+        // The levels for which encryptions of zero are precomputed. If empty, only the
+        // maximum ciphertext level (the default encryption level) is pooled.
+        std::vector<int> levels;
+        // The maximum number of precomputed encryptions of zero kept for each level
+        size_t depth = 16;
+        // Background threads start refilling a level once it holds fewer than this many
+        // encryptions, and continue until the level is full again.
+        size_t refill_threshold = 8;
+        // The number of background threads which generate encryptions of zero
+        int num_threads = 1;
+    };
+
+    struct ZeroEncryptionPoolStats {
+        // Encryptions which used a precomputed encryption of zero
+        uint64_t hits = 0;
+        // Encryptions which found the pool for their level empty (or the level not pooled),
+        // and fell back to inline encryption
+        uint64_t misses = 0;
+        // The total number of encryptions of zero generated by the background threads
+        uint64_t generated = 0;
+        // The number of encryptions of zero currently available at each pooled level
+        std::map<int, size_t> available;
+    };
+
+    /* An internal API for the HE backend.
+     * Public-key encryption is dominated by generating a fresh encryption of zero: sampling randomness,
+     * multiplying by the public key, and NTTs. None of this depends on the message, so it can be done
+     * ahead of time. This class maintains a bounded queue of fresh encryptions of zero for each level,
+     * which are generated by background threads. An encryption then only needs to encode the message
+     * and add it to a pooled encryption of zero.
+     *
+     * Each encryption of zero is handed out exactly once; reusing one would break the security of the scheme.
+     * If the generator throws an exception, the level it was generating stops refilling, so encryptions at that
+     * level fall back to inline encryption once its pool is empty (and are counted as misses). `fill` retries
+     * failed levels. The destructor stops the background threads, and waits for them to finish their current work.
+     */
+    class ZeroEncryptionPool {
+       public:
+        // Writes a fresh encryption of zero at the given level to the ciphertext.
+        // It is called concurrently from the background threads.
+        using Generator = std::function<void(int, seal::Ciphertext &)>;
+
+        // `max_level` is the maximum valid level; all levels in the config must be in [0, max_level].
+        ZeroEncryptionPool(const ZeroEncryptionPoolConfig &config, int max_level, Generator generate);
+
+        ~ZeroEncryptionPool();
+
+        ZeroEncryptionPool(const ZeroEncryptionPool &) = delete;
+        ZeroEncryptionPool &operator=(const ZeroEncryptionPool &) = delete;
+        ZeroEncryptionPool(ZeroEncryptionPool &&) = delete;
+        ZeroEncryptionPool &operator=(ZeroEncryptionPool &&) = delete;
+
+        // Move a precomputed encryption of zero at `level` to `destination`. Returns false,
+        // leaving `destination` unchanged, if none is available.
+        bool take(int level, seal::Ciphertext &destination);
+
+        /* Block until every pooled level is full. Levels whose generator failed are retried; if a level fails
+         * again, this function rethrows the exception once the other levels are full.
+         */
+        void fill();
+
+        ZeroEncryptionPoolStats stats() const;
+
+       private:
+        struct LevelPool {
+            std::deque<seal::Ciphertext> cts;
+            // number of encryptions currently being generated for this level
+            size_t in_flight = 0;
+            bool refilling = true;
+            // the last exception thrown while generating for this level, if the level has not been retried
+            std::exception_ptr error;
+        };
+
+        // must be called with the lock held; returns -1 if no level needs work
+        int next_level_to_refill();
+        void worker_loop();
+
+        size_t depth_;
+        size_t refill_threshold_;
+        Generator generate_;
+        std::map<int, LevelPool> pools_;
+        bool stop_ = false;
+        uint64_t hits_ = 0;
+        uint64_t misses_ = 0;
+        uint64_t generated_ = 0;
+        mutable std::mutex mutex_;
+        std::condition_variable refill_cv_;
+        std::condition_variable filled_cv_;
+        std::vector<std::thread> workers_;
+    };
+}  // namespace hit
@@ -5,9 +5,14 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
 #include <boost/numeric/ublas/matrix.hpp>
 #include <boost/numeric/ublas/vector.hpp>
 #include <chrono>
+#include <numeric>
+#include <vector>
+
+#include "scheduler.h"
 
 #define VLOG_EVAL 1
 #define VLOG_VERBOSE 2
@@ -37,6 +42,33 @@
         LOG_AND_THROW_STREAM(stream_contents);      \
     }
 
+/* Intended usage is:
+ *
+ *      parallel_for(x.size(), [&](int i) {
+ *          foo1;
+ *          foo2;
+ *          ...
+ *          foon;
+ *      });
+ *
+ * The loop runs in the TBB arena of the calling thread; see scheduler.h. Use a TaskScheduler directly
+ * to control the concurrency limit or grain size.
+ */
+
+// https://stackoverflow.com/a/10379844/925978
+#define COMBINE1(X, Y) X##Y  // helper macro
+#define COMBINE(X, Y) COMBINE1(X, Y)
+
+#ifdef DISABLE_PARALLELISM
+#define UNIQUE_ID() COMBINE(i, __LINE__)
+#define parallel_for(max_idx, body)                                     \
+    for (int UNIQUE_ID() = 0; UNIQUE_ID() < (max_idx); UNIQUE_ID()++) { \
+        body(UNIQUE_ID());                                              \
+    }
+#else /* !DISABLE_PARALLELISM */
+#define parallel_for(max_idx, body) hit::TaskScheduler::parallel_for_each_in_current_arena((max_idx), (body))
+#endif /* DISABLE_PARALLELISM */
+
 namespace hit {
     using Matrix = boost::numeric::ublas::matrix<double, boost::numeric::ublas::row_major, std::vector<double>>;
     using Vector = boost::numeric::ublas::vector<double, std::vector<double>>;
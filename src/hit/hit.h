@@ -5,8 +5,11 @@
 
 // This file includes most of the headers that are typically used in an application.
 
+#include "hit/api/asyncevaluator.h"
 #include "hit/api/ciphertext.h"
+#include "hit/api/circuitreplay.h"
 #include "hit/api/evaluator.h"
+#include "hit/api/evaluator/circuitrecorder.h"
 #include "hit/api/evaluator/debug.h"
 #include "hit/api/evaluator/explicitdepthfinder.h"
 #include "hit/api/evaluator/homomorphic.h"
@@ -15,6 +18,8 @@
 #include "hit/api/evaluator/plaintext.h"
 #include "hit/api/evaluator/rotations.h"
 #include "hit/api/evaluator/scaleestimator.h"
+#include "hit/api/keystore.h"
+#include "hit/api/linearalgebra/asyncencrypted.h"
 #include "hit/api/linearalgebra/encodingunit.h"
 #include "hit/api/linearalgebra/encryptedcolvector.h"
 #include "hit/api/linearalgebra/encryptedmatrix.h"
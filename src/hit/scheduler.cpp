@@ -0,0 +1,185 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "scheduler.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#ifndef DISABLE_PARALLELISM
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+#endif
+
+#include "common.h"
+
+using namespace std;
+
+namespace hit {
+
+    void FutureState::on_ready(function<void()> continuation) {
+        {
+            scoped_lock lock(mutex_);
+            if (!ready_) {
+                continuations_.push_back(move(continuation));
+                return;
+            }
+        }
+        continuation();
+    }
+
+    void FutureState::wait() const {
+        unique_lock<mutex> lock(mutex_);
+        ready_cv_.wait(lock, [this]() { return ready_; });
+    }
+
+    bool FutureState::is_ready() const {
+        scoped_lock lock(mutex_);
+        return ready_;
+    }
+
+    void FutureState::set_exception(exception_ptr error) {
+        set_ready(move(error));
+    }
+
+    void FutureState::set_ready(exception_ptr error) {
+        vector<function<void()>> continuations;
+        {
+            scoped_lock lock(mutex_);
+            ready_ = true;
+            error_ = move(error);
+            continuations.swap(continuations_);
+        }
+        ready_cv_.notify_all();
+        for (auto &continuation : continuations) {
+            continuation();
+        }
+    }
+
+    void FutureState::wait_and_check() const {
+        wait();
+        if (error_) {
+            rethrow_exception(error_);
+        }
+    }
+
+    struct TaskScheduler::Arena {
+#ifndef DISABLE_PARALLELISM
+        tbb::task_arena arena;
+#endif
+        mutex pending_mutex;
+        // signaled when `num_pending` drops to zero
+        condition_variable idle;
+        // the number of operations from `submit` which have not finished
+        int num_pending = 0;
+    };
+
+#ifdef DISABLE_PARALLELISM
+    TaskScheduler::TaskScheduler(int max_concurrency) : arena_(make_unique<Arena>()), max_concurrency_(1) {
+        if (max_concurrency < 0) {
+            LOG_AND_THROW_STREAM("max_concurrency must be non-negative; got " << max_concurrency);
+        }
+    }
+
+    void TaskScheduler::parallel_for_each(int num_iterations, const function<void(int)> &body, int grain_size) const {
+        parallel_for_each_in_current_arena(num_iterations, body, grain_size);
+    }
+
+    void TaskScheduler::parallel_for_each_in_current_arena(int num_iterations, const function<void(int)> &body,
+                                                           int grain_size) {
+        if (grain_size < 1) {
+            LOG_AND_THROW_STREAM("grain_size must be positive; got " << grain_size);
+        }
+        for (int i = 0; i < num_iterations; i++) {
+            body(i);
+        }
+    }
+
+    void TaskScheduler::enqueue(function<void()> task) const {
+        task();
+    }
+#else  /* !DISABLE_PARALLELISM */
+    TaskScheduler::TaskScheduler(int max_concurrency) {
+        if (max_concurrency < 0) {
+            LOG_AND_THROW_STREAM("max_concurrency must be non-negative; got " << max_concurrency);
+        }
+        arena_ = make_unique<Arena>();
+        arena_->arena.initialize(max_concurrency == 0 ? tbb::task_arena::automatic : max_concurrency);
+        max_concurrency_ = arena_->arena.max_concurrency();
+    }
+
+    void TaskScheduler::parallel_for_each(int num_iterations, const function<void(int)> &body, int grain_size) const {
+        // If the calling thread is already in this arena (i.e., this is a nested loop), `execute` runs immediately.
+        arena_->arena.execute([&]() { parallel_for_each_in_current_arena(num_iterations, body, grain_size); });
+    }
+
+    void TaskScheduler::parallel_for_each_in_current_arena(int num_iterations, const function<void(int)> &body,
+                                                           int grain_size) {
+        if (grain_size < 1) {
+            LOG_AND_THROW_STREAM("grain_size must be positive; got " << grain_size);
+        }
+        if (num_iterations <= 0) {
+            return;
+        }
+        // The name is parenthesized so that it is not expanded by the `parallel_for` macro in common.h
+        (tbb::parallel_for)(tbb::blocked_range<int>(0, num_iterations, grain_size),
+                            [&](const tbb::blocked_range<int> &range) {
+                                for (int i = range.begin(); i != range.end(); i++) {
+                                    body(i);
+                                }
+                            });
+    }
+
+    void TaskScheduler::enqueue(function<void()> task) const {
+        arena_->arena.enqueue(move(task));
+    }
+#endif /* DISABLE_PARALLELISM */
+
+    TaskScheduler::~TaskScheduler() {
+        wait();
+    }
+
+    int TaskScheduler::max_concurrency() const {
+        return max_concurrency_;
+    }
+
+    void TaskScheduler::schedule(vector<shared_ptr<FutureState>> inputs, function<void()> task) const {
+        {
+            scoped_lock lock(arena_->pending_mutex);
+            arena_->num_pending++;
+        }
+        // One count for each input, and one which is released once every continuation has been registered, so
+        // that the task cannot be launched while its inputs are still being registered.
+        auto num_waiting = make_shared<atomic<size_t>>(inputs.size() + 1);
+        auto body = make_shared<function<void()>>(move(task));
+        auto release = [this, num_waiting, body]() {
+            if (--*num_waiting > 0) {
+                return;
+            }
+            enqueue([this, body]() mutable {
+                (*body)();
+                // release the task's captures (e.g., its inputs) before this scheduler may be destroyed
+                body.reset();
+                scoped_lock lock(arena_->pending_mutex);
+                arena_->num_pending--;
+                if (arena_->num_pending == 0) {
+                    // this scheduler may be destroyed as soon as the lock is released
+                    arena_->idle.notify_all();
+                }
+            });
+        };
+        for (const auto &input : inputs) {
+            input->on_ready(release);
+        }
+        release();
+    }
+
+    void TaskScheduler::wait() const {
+        unique_lock<mutex> lock(arena_->pending_mutex);
+        arena_->idle.wait(lock, [this]() { return arena_->num_pending == 0; });
+    }
+}  // namespace hit
@@ -0,0 +1,219 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace hit {
+
+    /* The shared state of a `Future`. When the state becomes ready, it runs the continuations registered with
+     * `on_ready`, which is how TaskScheduler starts an operation as soon as its last input is ready.
+     */
+    class FutureState {
+       public:
+        FutureState() = default;
+        virtual ~FutureState() = default;
+
+        FutureState(const FutureState &) = delete;
+        FutureState &operator=(const FutureState &) = delete;
+        FutureState(FutureState &&) = delete;
+        FutureState &operator=(FutureState &&) = delete;
+
+        /* Run `continuation` once this state is ready: immediately on the calling thread if it is already
+         * ready, and otherwise on the thread which makes it ready. `continuation` must not throw an exception.
+         */
+        void on_ready(std::function<void()> continuation);
+
+        // Block until this state is ready.
+        void wait() const;
+
+        bool is_ready() const;
+
+        // Mark this state as ready, holding an exception, and run the continuations.
+        void set_exception(std::exception_ptr error);
+
+       protected:
+        // Mark this state as ready and run the continuations. `error` is null if the state holds a value.
+        void set_ready(std::exception_ptr error);
+
+        // Block until this state is ready, and rethrow its exception, if any.
+        void wait_and_check() const;
+
+       private:
+        mutable std::mutex mutex_;
+        mutable std::condition_variable ready_cv_;
+        bool ready_ = false;
+        std::exception_ptr error_;
+        std::vector<std::function<void()>> continuations_;
+    };
+
+    // A `FutureState` which holds a value of type `T`. The value (or an exception) must be set exactly once.
+    template <typename T>
+    class FutureValue : public FutureState {
+       public:
+        void set_value(T value) {
+            // the value is published by the lock in `set_ready`
+            value_ = std::move(value);
+            set_ready(nullptr);
+        }
+
+        const T &get() const {
+            wait_and_check();
+            return *value_;
+        }
+
+       private:
+        std::optional<T> value_;
+    };
+
+    /* The result of an asynchronous operation, e.g., one scheduled with `TaskScheduler::submit`. Like
+     * `std::shared_future`, a future can be copied, and every copy refers to the same result. Unlike
+     * `std::shared_future`, a future notifies the operations which depend on it when it becomes ready, so they
+     * never poll their inputs.
+     */
+    template <typename T>
+    class Future {
+       public:
+        // An invalid future, which does not refer to a result.
+        Future() = default;
+
+        explicit Future(std::shared_ptr<FutureValue<T>> state) : state_(std::move(state)) {
+        }
+
+        // Block until the result is ready, and return it. If the operation threw an exception, it is rethrown.
+        const T &get() const {
+            return state_->get();
+        }
+
+        // Block until the result is ready.
+        void wait() const {
+            state_->wait();
+        }
+
+        bool is_ready() const {
+            return state_->is_ready();
+        }
+
+        bool valid() const {
+            return state_ != nullptr;
+        }
+
+       private:
+        std::shared_ptr<FutureValue<T>> state_;
+
+        friend class TaskScheduler;
+    };
+
+    /* Runs parallel loops in a TBB task arena with a fixed concurrency limit. Loops nested inside the body
+     * of a loop (e.g., an evaluator's parallel encryption called from a LinearAlgebra loop) run in the same
+     * arena, so they share its threads and respect its limit. If the body of a loop throws an exception, the
+     * remaining iterations are cancelled and the exception is rethrown to the caller.
+     *
+     * When HIT is built with DISABLE_PARALLELISM, loops run sequentially on the calling thread.
+     */
+    class TaskScheduler {
+       public:
+        /* Create an arena which runs at most `max_concurrency` iterations at once (including the calling
+         * thread). If `max_concurrency` is 0, the limit is the number of hardware threads.
+         */
+        explicit TaskScheduler(int max_concurrency = 0);
+
+        ~TaskScheduler();
+
+        TaskScheduler(const TaskScheduler &) = delete;
+        TaskScheduler &operator=(const TaskScheduler &) = delete;
+        TaskScheduler(TaskScheduler &&) = delete;
+        TaskScheduler &operator=(TaskScheduler &&) = delete;
+
+        int max_concurrency() const;
+
+        /* Run `body(i)` for each 0 <= i < `num_iterations` in this arena. Iterations are scheduled in chunks
+         * of at least `grain_size` iterations; a grain size larger than 1 reduces scheduling overhead for
+         * loops with many cheap iterations. This function is thread-safe.
+         */
+        void parallel_for_each(int num_iterations, const std::function<void(int)> &body, int grain_size = 1) const;
+
+        /* As above, but in the arena of the calling thread. Inside the body of a TaskScheduler loop, this is
+         * that scheduler's arena; otherwise it is TBB's default arena. This is used by the `parallel_for` macro.
+         */
+        static void parallel_for_each_in_current_arena(int num_iterations, const std::function<void(int)> &body,
+                                                       int grain_size = 1);
+
+        /* Run `task` asynchronously in this arena, and return immediately. `task` must not throw an exception.
+         * When HIT is built with DISABLE_PARALLELISM, `task` runs on the calling thread before this returns.
+         */
+        void enqueue(std::function<void()> task) const;
+
+        /* Compute `op(inputs.get()...)` in this arena once every input is ready, and return a future for the
+         * result immediately. The operation counts its inputs which are not yet ready, and is launched by
+         * whichever input completes the count, so operations never block or poll waiting for their inputs.
+         * Inputs may be the results of any scheduler, or futures which are already ready (see
+         * `make_ready_future`). If an input holds an exception, or `op` throws an exception, the result holds
+         * the exception.
+         */
+        template <typename R, typename F, typename... Args>
+        Future<R> submit(F op, const Future<Args> &...inputs) const {
+            auto result = std::make_shared<FutureValue<R>>();
+            schedule({inputs.state_...}, [op, result, inputs...]() {
+                try {
+                    result->set_value(op(inputs.get()...));
+                } catch (...) {
+                    result->set_exception(std::current_exception());
+                }
+            });
+            return Future<R>(result);
+        }
+
+        // As above, for any number of inputs of the same type. `op` receives pointers to the values of `inputs`.
+        template <typename R, typename T, typename F>
+        Future<R> submit_all(F op, std::vector<Future<T>> inputs) const {
+            auto result = std::make_shared<FutureValue<R>>();
+            std::vector<std::shared_ptr<FutureState>> states;
+            states.reserve(inputs.size());
+            for (const auto &input : inputs) {
+                states.push_back(input.state_);
+            }
+            schedule(std::move(states), [op, result, inputs = std::move(inputs)]() {
+                try {
+                    std::vector<const T *> values;
+                    values.reserve(inputs.size());
+                    for (const auto &input : inputs) {
+                        // rethrows the exception if an input failed
+                        values.push_back(&input.get());
+                    }
+                    result->set_value(op(values));
+                } catch (...) {
+                    result->set_exception(std::current_exception());
+                }
+            });
+            return Future<R>(result);
+        }
+
+        // Block until every operation started by `submit` has finished. The destructor calls this function.
+        void wait() const;
+
+       private:
+        // Enqueue `task` once every state in `inputs` is ready. `task` must not throw an exception.
+        void schedule(std::vector<std::shared_ptr<FutureState>> inputs, std::function<void()> task) const;
+
+        struct Arena;
+        std::unique_ptr<Arena> arena_;
+        int max_concurrency_;
+    };
+
+    // Returns a future which is already ready, holding `value`.
+    template <typename T>
+    Future<T> make_ready_future(const T &value) {
+        auto state = std::make_shared<FutureValue<T>>();
+        state->set_value(value);
+        return Future<T>(state);
+    }
+}  // namespace hit
@@ -0,0 +1,62 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "hit/api/asyncevaluator.h"
+
+#include "../testutil.h"
+#include "gtest/gtest.h"
+#include "hit/api/evaluator/homomorphic.h"
+#include "hit/common.h"
+
+using namespace std;
+using namespace hit;
+
+// Test variables.
+const int RANGE = 16;
+const int NUM_OF_SLOTS = 4096;
+const int ONE_MULTI_DEPTH = 1;
+const int LOG_SCALE = 30;
+const int STEPS = 1;
+
+TEST(AsyncEvaluatorTest, Circuit) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE, vector<int>{STEPS});
+    AsyncEvaluator async_instance(ckks_instance, 2);
+    vector<double> vector1 = random_vector(NUM_OF_SLOTS, RANGE);
+    vector<double> vector2 = random_vector(NUM_OF_SLOTS, RANGE);
+
+    // two independent branches: x*y, and x rotated
+    AsyncCiphertext x = async_instance.encrypt(vector1);
+    AsyncCiphertext y = AsyncEvaluator::ready(ckks_instance.encrypt(vector2));
+    AsyncCiphertext product = async_instance.multiply_relin_rescale(x, y);
+    AsyncCiphertext rotated = async_instance.rotate_left(x, STEPS);
+    AsyncCiphertext sum = async_instance.add(product, async_instance.reduce_level_to(rotated, product));
+    AsyncCiphertext result = async_instance.add_many({sum, product, async_instance.negate(product)});
+
+    vector<double> expected(NUM_OF_SLOTS);
+    for (int i = 0; i < NUM_OF_SLOTS; i++) {
+        expected[i] = vector1[i] * vector2[i] + vector1[(i + STEPS) % NUM_OF_SLOTS];
+    }
+    ASSERT_LE(relative_error(expected, ckks_instance.decrypt(result.get())), MAX_NORM);
+    ASSERT_EQ(result.get().he_level(), 0);
+    async_instance.wait();
+}
+
+TEST(AsyncEvaluatorTest, Exceptions) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE);
+    AsyncEvaluator async_instance(ckks_instance);
+    vector<double> vector1 = random_vector(NUM_OF_SLOTS, RANGE);
+    AsyncCiphertext x = async_instance.encrypt(vector1);
+    AsyncCiphertext y = async_instance.encrypt(vector1, 0);
+
+    // Expect invalid_argument is thrown because the inputs are at different levels
+    AsyncCiphertext sum = async_instance.add(x, y);
+    ASSERT_THROW(sum.get(), invalid_argument);
+    // Operations which depend on a failed operation fail with the same exception
+    ASSERT_THROW(async_instance.add_plain(sum, 1).get(), invalid_argument);
+    // Independent operations are unaffected
+    ASSERT_LE(relative_error(vector1, ckks_instance.decrypt(async_instance.negate(async_instance.negate(x)).get())),
+              MAX_NORM);
+
+    // Expect invalid_argument is thrown because the inputs have different sizes
+    ASSERT_THROW(async_instance.inner_product({x}, {x, x}), invalid_argument);
+}
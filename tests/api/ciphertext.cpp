@@ -32,3 +32,45 @@ TEST(CKKSCiphertextTest, Serialization) {
     vector<double> vector2 = ckks_instance.decrypt(ciphertext2);
     ASSERT_LT(relative_error(vector1, vector2), MAX_NORM);
 }
+
+// fresh ciphertexts produced by secret-key encryption serialize in seeded form,
+// which is smaller than a public-key encryption and decrypts to the same message.
+TEST(CKKSCiphertextTest, SeededSerialization) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ZERO_MULTI_DEPTH, LOG_SCALE);
+
+    vector<double> vector1 = random_vector(NUM_OF_SLOTS, RANGE);
+    CKKSCiphertext public_ct = ckks_instance.encrypt(vector1);
+    ckks_instance.set_symmetric_encryption(true);
+    CKKSCiphertext seeded_ct = ckks_instance.encrypt(vector1);
+
+    hit::protobuf::Ciphertext *public_proto = public_ct.serialize();
+    hit::protobuf::Ciphertext *seeded_proto = seeded_ct.serialize();
+    ASSERT_LT(seeded_proto->ct().size(), public_proto->ct().size());
+
+    CKKSCiphertext ciphertext2(ckks_instance.context, *seeded_proto);
+    vector<double> vector2 = ckks_instance.decrypt(ciphertext2);
+    ASSERT_LT(relative_error(vector1, vector2), MAX_NORM);
+    delete public_proto;
+    delete seeded_proto;
+}
+
+// once a seeded ciphertext is modified, it must be serialized in full.
+TEST(CKKSCiphertextTest, SeededSerialization_AfterEvaluation) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ZERO_MULTI_DEPTH, LOG_SCALE);
+    ckks_instance.set_symmetric_encryption(true);
+
+    vector<double> vector1 = random_vector(NUM_OF_SLOTS, RANGE);
+    vector<double> vector2 = random_vector(NUM_OF_SLOTS, RANGE);
+    CKKSCiphertext ciphertext1 = ckks_instance.encrypt(vector1);
+    CKKSCiphertext ciphertext2 = ckks_instance.add_plain(ciphertext1, vector2);
+
+    hit::protobuf::Ciphertext *ciphertext2_proto = ciphertext2.serialize();
+    CKKSCiphertext ciphertext3(ckks_instance.context, *ciphertext2_proto);
+    vector<double> actual = ckks_instance.decrypt(ciphertext3);
+    vector<double> expected(NUM_OF_SLOTS);
+    for (int i = 0; i < NUM_OF_SLOTS; i++) {
+        expected[i] = vector1[i] + vector2[i];
+    }
+    ASSERT_LT(relative_error(expected, actual), MAX_NORM);
+    delete ciphertext2_proto;
+}
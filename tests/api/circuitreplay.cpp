@@ -0,0 +1,87 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "hit/api/circuitreplay.h"
+
+#include <sstream>
+
+#include "../testutil.h"
+#include "gtest/gtest.h"
+#include "hit/api/evaluator/circuitrecorder.h"
+#include "hit/api/evaluator/homomorphic.h"
+#include "hit/common.h"
+
+using namespace std;
+using namespace hit;
+
+// Test variables.
+const int RANGE = 16;
+const int NUM_OF_SLOTS = 4096;
+const int ONE_MULTI_DEPTH = 1;
+const int LOG_SCALE = 30;
+
+TEST(CircuitReplayTest, RecordAndReplay) {
+    CircuitRecorder recorder(NUM_OF_SLOTS, ONE_MULTI_DEPTH);
+    vector<double> weights = random_vector(NUM_OF_SLOTS, RANGE);
+    CKKSCiphertext x = recorder.encrypt(vector<double>(NUM_OF_SLOTS));
+    CKKSCiphertext y = recorder.encrypt(vector<double>(NUM_OF_SLOTS));
+    vector<CKKSCiphertext> rotated = recorder.rotate_many(x, {1, 2});
+    CKKSCiphertext product = recorder.inner_product({x, rotated[0]}, {y, y});
+    CKKSCiphertext scaled = recorder.multiply_plain_rescale(rotated[1], weights);
+    // this value does not contribute to an output, so it is not computed during replay
+    recorder.square(x);
+    recorder.mark_output(recorder.add(product, scaled));
+    recorder.mark_output(recorder.add_plain(recorder.reduce_level_to(x, 0), weights));
+
+    protobuf::Circuit *proto_circuit = recorder.serialize();
+    // the plaintext operand is only stored once
+    ASSERT_EQ(proto_circuit->plaintexts_size(), 1);
+    ASSERT_EQ(proto_circuit->outputs_size(), 2);
+    delete proto_circuit;
+
+    stringstream buffer;
+    recorder.save(buffer);
+    CircuitReplay replay(buffer, 2);
+    ASSERT_EQ(replay.num_inputs(), 2);
+    ASSERT_EQ(replay.num_outputs(), 2);
+
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE, vector<int>{1, 2});
+    vector<double> vector1 = random_vector(NUM_OF_SLOTS, RANGE);
+    vector<double> vector2 = random_vector(NUM_OF_SLOTS, RANGE);
+    vector<CKKSCiphertext> outputs =
+        replay.run(ckks_instance, {ckks_instance.encrypt(vector1), ckks_instance.encrypt(vector2)});
+    ASSERT_EQ(outputs.size(), 2);
+
+    vector<double> expected1(NUM_OF_SLOTS);
+    vector<double> expected2(NUM_OF_SLOTS);
+    for (int i = 0; i < NUM_OF_SLOTS; i++) {
+        expected1[i] = (vector1[i] + vector1[(i + 1) % NUM_OF_SLOTS]) * vector2[i] +
+                       vector1[(i + 2) % NUM_OF_SLOTS] * weights[i];
+        expected2[i] = vector1[i] + weights[i];
+    }
+    ASSERT_LE(relative_error(expected1, ckks_instance.decrypt(outputs[0])), MAX_NORM);
+    ASSERT_LE(relative_error(expected2, ckks_instance.decrypt(outputs[1])), MAX_NORM);
+    ASSERT_EQ(outputs[0].he_level(), 0);
+}
+
+TEST(CircuitReplayTest, Exceptions) {
+    CircuitRecorder recorder(NUM_OF_SLOTS, ONE_MULTI_DEPTH);
+    CKKSCiphertext x = recorder.encrypt(vector<double>(NUM_OF_SLOTS));
+    // Expect invalid_argument is thrown because the ciphertext is not part of the circuit
+    ASSERT_THROW(recorder.mark_output(CKKSCiphertext()), invalid_argument);
+    recorder.mark_output(recorder.multiply_plain_rescale(x, 2.0));
+
+    protobuf::Circuit *proto_circuit = recorder.serialize();
+    CircuitReplay replay(*proto_circuit);
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE);
+    CKKSCiphertext input = ckks_instance.encrypt(random_vector(NUM_OF_SLOTS, RANGE));
+    // Expect invalid_argument is thrown because the circuit has one input
+    ASSERT_THROW(replay.run(ckks_instance, {input, input}), invalid_argument);
+    // Expect invalid_argument is thrown because the input is not at the recorded level
+    ASSERT_THROW(replay.run(ckks_instance, {ckks_instance.reduce_level_to(input, 0)}), invalid_argument);
+
+    // Expect invalid_argument is thrown because the operation reads a value before it is computed
+    proto_circuit->mutable_ops(1)->set_inputs(0, 1);
+    ASSERT_THROW(CircuitReplay{*proto_circuit}, invalid_argument);
+    delete proto_circuit;
+}
@@ -0,0 +1,97 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "hit/api/context.h"
+
+#include <thread>
+
+#include "../testutil.h"
+#include "gtest/gtest.h"
+#include "hit/api/evaluator/homomorphic.h"
+#include "hit/common.h"
+
+using namespace std;
+using namespace hit;
+
+// Test variables.
+const int NUM_OF_SLOTS = 4096;
+const int THREE_MULTI_DEPTH = 3;
+const int LOG_SCALE = 30;
+
+// the precomputed tables agree with a walk of the SEAL modulus chain
+TEST(HEContextTest, LevelTables) {
+    HEContext context(CKKSParams(NUM_OF_SLOTS, THREE_MULTI_DEPTH, LOG_SCALE, true));
+
+    double log_modulus = 0;
+    auto context_data = context.seal_ctx->first_context_data();
+    for (int level = THREE_MULTI_DEPTH; level >= 0; level--) {
+        ASSERT_EQ(context.get_context_data(level), context_data);
+        ASSERT_EQ(context.parms_id(level), context_data->parms_id());
+        ASSERT_EQ(context.get_qi(level), context_data->parms().coeff_modulus().back().value());
+        context_data = context_data->next_context_data();
+    }
+    for (int level = 0; level <= THREE_MULTI_DEPTH; level++) {
+        log_modulus += log2(context.get_qi(level));
+        ASSERT_EQ(context.log_modulus(level), log_modulus);
+    }
+
+    double scale = pow(2, LOG_SCALE);
+    for (int level = THREE_MULTI_DEPTH; level >= 0; level--) {
+        ASSERT_EQ(context.fresh_scale(level), scale);
+        scale = (scale * scale) / static_cast<double>(context.get_qi(level));
+    }
+
+    // Expect invalid_argument is thrown because the level is out of bounds
+    ASSERT_THROW(context.get_context_data(THREE_MULTI_DEPTH + 1), invalid_argument);
+    ASSERT_THROW(context.fresh_scale(-1), invalid_argument);
+}
+
+// ciphertexts encrypted at each level have the tabulated scale
+TEST(HEContextTest, FreshScale) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, THREE_MULTI_DEPTH, LOG_SCALE);
+    vector<double> coeffs(NUM_OF_SLOTS, 1);
+    for (int level = 0; level <= THREE_MULTI_DEPTH; level++) {
+        CKKSCiphertext ct = ckks_instance.encrypt(coeffs, level);
+        ASSERT_EQ(ct.scale(), ckks_instance.context->fresh_scale(level));
+        ASSERT_EQ(ct.he_level(), level);
+    }
+}
+
+// evaluators with identical parameters share a single context
+TEST(HEContextTest, SharedContext) {
+    CKKSParams params(NUM_OF_SLOTS, THREE_MULTI_DEPTH, LOG_SCALE, true);
+    shared_ptr<HEContext> context1 = HEContext::shared(params);
+    shared_ptr<HEContext> context2 = HEContext::shared(CKKSParams(NUM_OF_SLOTS, THREE_MULTI_DEPTH, LOG_SCALE, true));
+    ASSERT_EQ(context1, context2);
+
+    shared_ptr<HEContext> context3 =
+        HEContext::shared(CKKSParams(NUM_OF_SLOTS, THREE_MULTI_DEPTH, LOG_SCALE + 1, true));
+    ASSERT_NE(context1, context3);
+    shared_ptr<HEContext> context4 =
+        HEContext::shared(CKKSParams(NUM_OF_SLOTS, THREE_MULTI_DEPTH - 1, LOG_SCALE, true));
+    ASSERT_NE(context1, context4);
+
+    HomomorphicEval ckks_instance1 = HomomorphicEval(NUM_OF_SLOTS, THREE_MULTI_DEPTH, LOG_SCALE);
+    HomomorphicEval ckks_instance2 = HomomorphicEval(NUM_OF_SLOTS, THREE_MULTI_DEPTH, LOG_SCALE);
+    ASSERT_EQ(ckks_instance1.context, ckks_instance2.context);
+}
+
+// concurrent callers with the same parameters construct a single context, and callers with different
+// parameters construct theirs concurrently
+TEST(HEContextTest, SharedContextConcurrent) {
+    const int num_threads = 4;
+    vector<shared_ptr<HEContext>> contexts(2 * num_threads);
+    vector<thread> threads;
+    for (int i = 0; i < 2 * num_threads; i++) {
+        threads.emplace_back([&contexts, i]() {
+            contexts[i] = HEContext::shared(CKKSParams(NUM_OF_SLOTS, THREE_MULTI_DEPTH, LOG_SCALE + i % 2, true));
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    for (int i = 2; i < 2 * num_threads; i++) {
+        ASSERT_EQ(contexts[i], contexts[i % 2]);
+    }
+    ASSERT_NE(contexts[0], contexts[1]);
+}
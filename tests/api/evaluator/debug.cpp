@@ -38,3 +38,15 @@ TEST(DebugTest, Serialization) {
     transform(vector_input.begin(), vector_input.end(), vector_input.begin(), expected_output.begin(), multiplies<>());
     ASSERT_LE(relative_error(expected_output, vector_output), MAX_NORM);
 }
+
+TEST(DebugTest, ReduceLevelTo) {
+    const int max_level = 3;
+    DebugEval ckks_instance = DebugEval(NUM_OF_SLOTS, max_level, LOG_SCALE);
+    vector<double> vector_input = random_vector(NUM_OF_SLOTS, RANGE);
+    CKKSCiphertext ciphertext = ckks_instance.encrypt(vector_input);
+    // DebugEval throws if the HIT scale and SEAL scale diverge
+    ckks_instance.reduce_level_to_inplace(ciphertext, 0);
+    ASSERT_EQ(ciphertext.he_level(), 0);
+    ASSERT_EQ(ciphertext.scale(), ciphertext.backend_scale());
+    ASSERT_LE(relative_error(vector_input, ckks_instance.decrypt(ciphertext)), MAX_NORM);
+}
@@ -88,6 +88,299 @@ TEST(HomomorphicTest, Serialization_WithSecret) {
     ASSERT_LE(relative_error(expected_output, vector_output), MAX_NORM);
 }
 
+TEST(HomomorphicTest, Serialization_SEALKeys) {
+    vector<int> rotations{1, -1};
+    HomomorphicEval ckks_instance1 = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE, rotations);
+
+    // by default, keys are serialized directly by SEAL
+    stringstream paramsStream(ios::in | ios::out | ios::binary);
+    stringstream galoisKeyStream(ios::in | ios::out | ios::binary);
+    stringstream relinKeyStream(ios::in | ios::out | ios::binary);
+    ckks_instance1.save(paramsStream, galoisKeyStream, relinKeyStream, nullptr);
+    ASSERT_FALSE(has_key_chunks(galoisKeyStream));
+    ASSERT_FALSE(has_key_chunks(relinKeyStream));
+    seal::GaloisKeys galois_keys;
+    galois_keys.load(*(ckks_instance1.context->seal_ctx), galoisKeyStream);
+    ASSERT_EQ(galois_keys.size(), ckks_instance1.num_resident_galois_keys());
+    seal::RelinKeys relin_keys;
+    relin_keys.load(*(ckks_instance1.context->seal_ctx), relinKeyStream);
+    ASSERT_EQ(relin_keys.size(), 1);
+}
+
+TEST(HomomorphicTest, Serialization_ChunkedKeys) {
+    vector<int> rotations{1, -1};
+    HomomorphicEval ckks_instance1 = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE, rotations);
+
+    stringstream paramsStream(ios::in | ios::out | ios::binary);
+    stringstream galoisKeyStream(ios::in | ios::out | ios::binary);
+    stringstream relinKeyStream(ios::in | ios::out | ios::binary);
+    ckks_instance1.save(paramsStream, galoisKeyStream, relinKeyStream, nullptr, false, true);
+    ASSERT_TRUE(has_key_chunks(galoisKeyStream));
+    ASSERT_TRUE(has_key_chunks(relinKeyStream));
+    HomomorphicEval ckks_instance2 = HomomorphicEval(paramsStream, galoisKeyStream, relinKeyStream);
+
+    vector<double> vector1 = random_vector(NUM_OF_SLOTS, RANGE);
+    CKKSCiphertext ciphertext1 = ckks_instance1.encrypt(vector1);
+    CKKSCiphertext ciphertext2 = ckks_instance2.rotate_left(ciphertext1, 1);
+    ckks_instance2.square_inplace(ciphertext2);
+    ckks_instance2.relinearize_inplace(ciphertext2);
+    ckks_instance2.rescale_to_next_inplace(ciphertext2);
+    vector<double> expected(NUM_OF_SLOTS);
+    for (int i = 0; i < NUM_OF_SLOTS; i++) {
+        double rotated = vector1[(i + 1) % NUM_OF_SLOTS];
+        expected[i] = rotated * rotated;
+    }
+    ASSERT_LE(relative_error(expected, ckks_instance1.decrypt(ciphertext2)), MAX_NORM);
+}
+
+TEST(HomomorphicTest, Serialization_ChunkedKeys_BadChunkSize) {
+    HomomorphicEval ckks_instance1 = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE, vector<int>{1});
+
+    stringstream paramsStream(ios::in | ios::out | ios::binary);
+    stringstream galoisKeyStream(ios::in | ios::out | ios::binary);
+    stringstream relinKeyStream(ios::in | ios::out | ios::binary);
+    ckks_instance1.save(paramsStream, galoisKeyStream, relinKeyStream, nullptr, false, true);
+
+    // The stream starts with the magic string, the table size, the number of chunks, and a (table index, chunk
+    // size) pair for each chunk. Replace the size of the first chunk.
+    string galois_keys = galoisKeyStream.str();
+    uint64_t chunk_size = UINT64_MAX;
+    galois_keys.replace(4 * sizeof(uint64_t), sizeof(chunk_size), reinterpret_cast<const char *>(&chunk_size),
+                        sizeof(chunk_size));
+    stringstream badGaloisKeyStream(galois_keys, ios::in | ios::binary);
+    // Expect invalid_argument is thrown because the stream ends before the chunk does
+    ASSERT_THROW((HomomorphicEval{paramsStream, badGaloisKeyStream, relinKeyStream}), invalid_argument);
+}
+
+TEST(HomomorphicTest, Serialization_SeededKeys) {
+    vector<int> rotations{1, -1};
+    HomomorphicEval ckks_instance1 = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE, rotations);
+
+    stringstream paramsStream(ios::in | ios::out | ios::binary);
+    stringstream galoisKeyStream(ios::in | ios::out | ios::binary);
+    stringstream relinKeyStream(ios::in | ios::out | ios::binary);
+    ckks_instance1.save(paramsStream, galoisKeyStream, relinKeyStream, nullptr, false, true);
+
+    stringstream seededParamsStream(ios::in | ios::out | ios::binary);
+    stringstream seededGaloisKeyStream(ios::in | ios::out | ios::binary);
+    stringstream seededRelinKeyStream(ios::in | ios::out | ios::binary);
+    ckks_instance1.save(seededParamsStream, seededGaloisKeyStream, seededRelinKeyStream, nullptr, true);
+    ASSERT_LT(seededGaloisKeyStream.str().size(), galoisKeyStream.str().size());
+    ASSERT_LT(seededRelinKeyStream.str().size(), relinKeyStream.str().size());
+
+    HomomorphicEval ckks_instance2 = HomomorphicEval(seededParamsStream, seededGaloisKeyStream, seededRelinKeyStream);
+    vector<double> vector1 = random_vector(NUM_OF_SLOTS, RANGE);
+    CKKSCiphertext ciphertext1 = ckks_instance1.encrypt(vector1);
+    CKKSCiphertext ciphertext2 = ckks_instance2.rotate_right(ciphertext1, 1);
+    ckks_instance2.square_inplace(ciphertext2);
+    ckks_instance2.relinearize_inplace(ciphertext2);
+    ckks_instance2.rescale_to_next_inplace(ciphertext2);
+    vector<double> expected(NUM_OF_SLOTS);
+    for (int i = 0; i < NUM_OF_SLOTS; i++) {
+        double rotated = vector1[(i - 1 + NUM_OF_SLOTS) % NUM_OF_SLOTS];
+        expected[i] = rotated * rotated;
+    }
+    ASSERT_LE(relative_error(expected, ckks_instance1.decrypt(ciphertext2)), MAX_NORM);
+
+    // Expect invalid_argument is thrown because an evaluation-only instance has no secret key
+    ASSERT_THROW(ckks_instance2.save(seededParamsStream, seededGaloisKeyStream, seededRelinKeyStream, nullptr, true),
+                 invalid_argument);
+}
+
+TEST(HomomorphicTest, GenerateKeysToFile) {
+    TempDir temp_dir;
+    const string key_file = temp_dir.path() + "/galois_keys.bin";
+    stringstream paramsStream(ios::in | ios::out | ios::binary);
+    stringstream relinKeyStream(ios::in | ios::out | ios::binary);
+    stringstream secretKeyStream(ios::in | ios::out | ios::binary);
+    HomomorphicEval::generate_keys(CKKSParams(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE, true), {1, -1}, paramsStream,
+                                   key_file, relinKeyStream, secretKeyStream);
+
+    HomomorphicEval ckks_instance = HomomorphicEval(paramsStream, key_file, relinKeyStream, secretKeyStream);
+    ASSERT_EQ(ckks_instance.num_resident_galois_keys(), 0);
+    vector<double> vector1 = random_vector(NUM_OF_SLOTS, RANGE);
+    CKKSCiphertext ciphertext1 = ckks_instance.encrypt(vector1);
+    CKKSCiphertext ciphertext2 = ckks_instance.rotate_right(ciphertext1, 1);
+    ckks_instance.square_inplace(ciphertext2);
+    ckks_instance.relinearize_inplace(ciphertext2);
+    ckks_instance.rescale_to_next_inplace(ciphertext2);
+    vector<double> expected(NUM_OF_SLOTS);
+    for (int i = 0; i < NUM_OF_SLOTS; i++) {
+        double rotated = vector1[(i - 1 + NUM_OF_SLOTS) % NUM_OF_SLOTS];
+        expected[i] = rotated * rotated;
+    }
+    ASSERT_LE(relative_error(expected, ckks_instance.decrypt(ciphertext2)), MAX_NORM);
+    ASSERT_EQ(ckks_instance.num_resident_galois_keys(), 1);
+}
+
+TEST(HomomorphicTest, ReloadKeys) {
+    HomomorphicEval ckks_instance1 = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE, vector<int>{1});
+    HomomorphicEval ckks_instance2 = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE, vector<int>{1});
+
+    stringstream paramsStream(ios::in | ios::out | ios::binary);
+    stringstream galoisKeyStream(ios::in | ios::out | ios::binary);
+    stringstream relinKeyStream(ios::in | ios::out | ios::binary);
+    ckks_instance1.save(paramsStream, galoisKeyStream, relinKeyStream, nullptr);
+    HomomorphicEval server = HomomorphicEval(paramsStream, galoisKeyStream, relinKeyStream);
+
+    // replace the evaluation keys of ckks_instance1 with those of ckks_instance2
+    stringstream paramsStream2(ios::in | ios::out | ios::binary);
+    stringstream galoisKeyStream2(ios::in | ios::out | ios::binary);
+    stringstream relinKeyStream2(ios::in | ios::out | ios::binary);
+    ckks_instance2.save(paramsStream2, galoisKeyStream2, relinKeyStream2, nullptr);
+    server.reload_keys(galoisKeyStream2, relinKeyStream2);
+
+    vector<double> vector1 = random_vector(NUM_OF_SLOTS, RANGE);
+    CKKSCiphertext ciphertext1 = ckks_instance2.encrypt(vector1);
+    CKKSCiphertext ciphertext2 = server.rotate_left(ciphertext1, 1);
+    server.square_inplace(ciphertext2);
+    server.relinearize_inplace(ciphertext2);
+    server.rescale_to_next_inplace(ciphertext2);
+    vector<double> expected(NUM_OF_SLOTS);
+    for (int i = 0; i < NUM_OF_SLOTS; i++) {
+        double rotated = vector1[(i + 1) % NUM_OF_SLOTS];
+        expected[i] = rotated * rotated;
+    }
+    ASSERT_LE(relative_error(expected, ckks_instance2.decrypt(ciphertext2)), MAX_NORM);
+}
+
+TEST(HomomorphicTest, AddGaloisSteps) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ZERO_MULTI_DEPTH, LOG_SCALE, vector<int>{1});
+    ASSERT_EQ(ckks_instance.num_resident_galois_keys(), 1);
+    ckks_instance.add_galois_steps({1, 3, -2});
+    ASSERT_EQ(ckks_instance.num_resident_galois_keys(), 3);
+
+    vector<double> vector1 = random_vector(NUM_OF_SLOTS, RANGE);
+    CKKSCiphertext ciphertext = ckks_instance.encrypt(vector1);
+    vector<int> steps{1, 3, -2};
+    vector<CKKSCiphertext> rotated = ckks_instance.rotate_many(ciphertext, steps);
+    for (int i = 0; i < steps.size(); i++) {
+        vector<double> expected(NUM_OF_SLOTS);
+        for (int j = 0; j < NUM_OF_SLOTS; j++) {
+            expected[j] = vector1[(j + steps[i] + NUM_OF_SLOTS) % NUM_OF_SLOTS];
+        }
+        ASSERT_LE(relative_error(expected, ckks_instance.decrypt(rotated[i])), MAX_NORM);
+    }
+
+    stringstream paramsStream(ios::in | ios::out | ios::binary);
+    stringstream galoisKeyStream(ios::in | ios::out | ios::binary);
+    stringstream relinKeyStream(ios::in | ios::out | ios::binary);
+    ckks_instance.save(paramsStream, galoisKeyStream, relinKeyStream, nullptr);
+    HomomorphicEval eval_instance = HomomorphicEval(paramsStream, galoisKeyStream, relinKeyStream);
+    // Expect invalid_argument is thrown because an evaluation-only instance has no secret key
+    ASSERT_THROW(eval_instance.add_galois_steps({2}), invalid_argument);
+}
+
+TEST(HomomorphicTest, Serialization_GaloisKeyFile) {
+    vector<int> rotations{1, 2, -1};
+    HomomorphicEval ckks_instance1 = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE, rotations);
+
+    TempDir temp_dir;
+    const string key_file = temp_dir.path() + "/galois_keys.bin";
+    stringstream paramsStream(ios::in | ios::out | ios::binary);
+    stringstream galoisKeyStream(ios::in | ios::out | ios::binary);
+    stringstream relinKeyStream(ios::in | ios::out | ios::binary);
+    ckks_instance1.save(paramsStream, galoisKeyStream, relinKeyStream, nullptr);
+    ckks_instance1.save_galois_key_file(key_file);
+
+    // keep at most one key in memory
+    HomomorphicEval ckks_instance2 = HomomorphicEval(paramsStream, key_file, relinKeyStream, 1);
+    ASSERT_EQ(ckks_instance2.num_resident_galois_keys(), 0);
+
+    vector<double> vector1 = random_vector(NUM_OF_SLOTS, RANGE);
+    CKKSCiphertext ciphertext1 = ckks_instance1.encrypt(vector1);
+    for (int step : rotations) {
+        CKKSCiphertext ciphertext2 = step > 0 ? ckks_instance2.rotate_left(ciphertext1, step)
+                                              : ckks_instance2.rotate_right(ciphertext1, -step);
+        ASSERT_EQ(ckks_instance2.num_resident_galois_keys(), 1);
+        vector<double> expected(NUM_OF_SLOTS);
+        for (int i = 0; i < NUM_OF_SLOTS; i++) {
+            expected[i] = vector1[(i + step + NUM_OF_SLOTS) % NUM_OF_SLOTS];
+        }
+        ASSERT_LE(relative_error(expected, ckks_instance1.decrypt(ciphertext2)), MAX_NORM);
+    }
+    // Expect invalid_argument is thrown because the keys are not all in memory
+    ASSERT_THROW(ckks_instance2.save_galois_key_file(key_file), invalid_argument);
+}
+
+TEST(HomomorphicTest, GaloisKeyFile_WrongKeyCount) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE, vector<int>{1, -1});
+    const seal::SEALContext &seal_ctx = *(ckks_instance.context->seal_ctx);
+    TempDir temp_dir;
+    const string key_file = temp_dir.path() + "/galois_keys.bin";
+    ckks_instance.save_galois_key_file(key_file);
+    GaloisKeyFile valid_file(key_file);
+    vector<uint32_t> galois_elts = valid_file.galois_elts();
+
+    // the first record has no keys, and the others are missing their last key
+    const string bad_key_file = temp_dir.path() + "/bad_galois_keys.bin";
+    GaloisKeyFile::write(bad_key_file, galois_elts,
+                         [&](uint32_t galois_elt, vector<seal::PublicKey> &storage) -> const vector<seal::PublicKey> & {
+                             valid_file.load(seal_ctx, galois_elt, storage);
+                             if (galois_elt == galois_elts[0]) {
+                                 storage.clear();
+                             } else {
+                                 storage.pop_back();
+                             }
+                             return storage;
+                         });
+    GaloisKeyFile bad_file(bad_key_file);
+    for (uint32_t galois_elt : galois_elts) {
+        vector<seal::PublicKey> key;
+        // Expect invalid_argument is thrown because the record does not have one key per ciphertext prime
+        ASSERT_THROW(bad_file.load(seal_ctx, galois_elt, key), invalid_argument);
+    }
+}
+
+TEST(HomomorphicTest, EncryptMany) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE);
+    vector<vector<double>> vectors;
+    for (int i = 0; i < 5; i++) {
+        vectors.push_back(random_vector(NUM_OF_SLOTS, RANGE));
+    }
+    vector<CKKSCiphertext> cts = ckks_instance.encrypt_many(vectors, ZERO_MULTI_DEPTH);
+    ASSERT_EQ(cts.size(), vectors.size());
+    CKKSCiphertext expected_ct = ckks_instance.encrypt(vectors[0], ZERO_MULTI_DEPTH);
+    for (int i = 0; i < vectors.size(); i++) {
+        // Check scale and he_level.
+        ASSERT_EQ(cts[i].he_level(), ZERO_MULTI_DEPTH);
+        ASSERT_EQ(cts[i].scale(), expected_ct.scale());
+        // Check vector values.
+        double diff = relative_error(vectors[i], ckks_instance.decrypt(cts[i]));
+        ASSERT_NE(diff, INVALID_NORM);
+        ASSERT_LE(diff, MAX_NORM);
+    }
+}
+
+TEST(HomomorphicTest, EncryptMany_InvalidCase) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE);
+    vector<vector<double>> vectors{random_vector(NUM_OF_SLOTS, RANGE), random_vector(NUM_OF_SLOTS / 2, RANGE)};
+    // Expect invalid_argument is thrown because the second vector has the wrong size.
+    ASSERT_THROW(ckks_instance.encrypt_many(vectors), invalid_argument);
+    // Expect invalid_argument is thrown because the level is too high.
+    ASSERT_THROW(ckks_instance.encrypt_many({vectors[0]}, ONE_MULTI_DEPTH + 1), invalid_argument);
+}
+
+TEST(HomomorphicTest, DecryptMany) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ZERO_MULTI_DEPTH, LOG_SCALE);
+    vector<vector<double>> vectors;
+    for (int i = 0; i < 5; i++) {
+        vectors.push_back(random_vector(NUM_OF_SLOTS, RANGE));
+    }
+    vector<CKKSCiphertext> cts = ckks_instance.encrypt_many(vectors);
+    vector<const CKKSCiphertext *> ct_ptrs;
+    for (const auto &ct : cts) {
+        ct_ptrs.push_back(&ct);
+    }
+    vector<vector<double>> outputs(cts.size());
+    ckks_instance.decrypt_many(ct_ptrs, [&](int i, const vector<double> &coeffs) { outputs[i] = coeffs; });
+    for (int i = 0; i < vectors.size(); i++) {
+        double diff = relative_error(vectors[i], outputs[i]);
+        ASSERT_NE(diff, INVALID_NORM);
+        ASSERT_LE(diff, MAX_NORM);
+    }
+}
+
 TEST(HomomorphicTest, RotateLeft) {
     vector<int> rotations(1);
     rotations[0] = STEPS;
@@ -145,6 +438,29 @@ TEST(HomomorphicTest, RotateRight) {
     ASSERT_LE(diff, MAX_NORM);
 }
 
+TEST(HomomorphicTest, RotateMany) {
+    // 5 is not in the list, so SEAL composes it from the keys for 1 and 4
+    vector<int> rotations{1, 3, 4, -2};
+    vector<int> steps{0, 1, 3, -2, 5};
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE, rotations);
+    vector<double> vector1 = random_vector(NUM_OF_SLOTS, RANGE);
+    CKKSCiphertext ciphertext1 = ckks_instance.encrypt(vector1);
+    vector<CKKSCiphertext> outputs = ckks_instance.rotate_many(ciphertext1, steps);
+    ASSERT_EQ(outputs.size(), steps.size());
+    for (int i = 0; i < steps.size(); i++) {
+        // Check scale and he_level.
+        ASSERT_EQ(outputs[i].he_level(), ONE_MULTI_DEPTH);
+        ASSERT_EQ(outputs[i].scale(), ciphertext1.scale());
+        vector<double> expected_output(NUM_OF_SLOTS);
+        for (int j = 0; j < NUM_OF_SLOTS; j++) {
+            expected_output[j] = vector1[(j + steps[i] + NUM_OF_SLOTS) % NUM_OF_SLOTS];
+        }
+        double diff = relative_error(expected_output, ckks_instance.decrypt(outputs[i], true));
+        ASSERT_NE(diff, INVALID_NORM);
+        ASSERT_LE(diff, MAX_NORM);
+    }
+}
+
 TEST(HomomorphicTest, RotateRight_InvalidCase) {
     HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ZERO_MULTI_DEPTH, LOG_SCALE);
     CKKSCiphertext ciphertext1;
@@ -154,6 +470,24 @@ TEST(HomomorphicTest, RotateRight_InvalidCase) {
                  invalid_argument);
 }
 
+TEST(HomomorphicTest, GenerateGaloisKeys_DuplicateSteps) {
+    // keys are generated in parallel; duplicate steps share a single key
+    vector<int> rotations{1, 2, 3, -1, 2};
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ZERO_MULTI_DEPTH, LOG_SCALE, rotations);
+    vector<double> vector1 = random_vector(NUM_OF_SLOTS, RANGE);
+    CKKSCiphertext ciphertext1 = ckks_instance.encrypt(vector1);
+    for (int step : rotations) {
+        CKKSCiphertext ciphertext2 = step > 0 ? ckks_instance.rotate_left(ciphertext1, step)
+                                              : ckks_instance.rotate_right(ciphertext1, -step);
+        vector<double> expected(NUM_OF_SLOTS);
+        for (int i = 0; i < NUM_OF_SLOTS; i++) {
+            expected[i] = vector1[(i + step + NUM_OF_SLOTS) % NUM_OF_SLOTS];
+        }
+        vector<double> actual = ckks_instance.decrypt(ciphertext2);
+        ASSERT_LE(relative_error(expected, actual), MAX_NORM);
+    }
+}
+
 TEST(HomomorphicTest, Negate) {
     HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ZERO_MULTI_DEPTH, LOG_SCALE);
     CKKSCiphertext ciphertext1, ciphertext2, ciphertext3;
@@ -360,6 +694,98 @@ TEST(HomomorphicTest, Multiply) {
     ASSERT_LE(diff, MAX_NORM);
 }
 
+TEST(HomomorphicTest, MultiplyRelinRescale) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE);
+    CKKSCiphertext ciphertext1, ciphertext2, ciphertext3;
+    vector<double> vector1 = random_vector(NUM_OF_SLOTS, RANGE);
+    vector<double> vector2 = random_vector(NUM_OF_SLOTS, RANGE);
+    ciphertext1 = ckks_instance.encrypt(vector1);
+    ciphertext2 = ckks_instance.encrypt(vector2);
+    vector<double> vector3(NUM_OF_SLOTS);
+    transform(vector1.begin(), vector1.end(), vector2.begin(), vector3.begin(), multiplies<>());
+    ciphertext3 = ckks_instance.multiply_relin_rescale(ciphertext1, ciphertext2);
+    // Check scale and he_level.
+    ASSERT_EQ(ciphertext3.he_level(), ZERO_MULTI_DEPTH);
+    uint64_t prime = ckks_instance.context->get_qi(ONE_MULTI_DEPTH);
+    ASSERT_EQ(ciphertext3.scale(), pow(2, LOG_SCALE * 2) / prime);
+    // Check vector values.
+    vector<double> vector4 = ckks_instance.decrypt(ciphertext3);
+    double diff = relative_error(vector3, vector4);
+    ASSERT_NE(diff, INVALID_NORM);
+    ASSERT_LE(diff, MAX_NORM);
+
+    // Expect invalid_argument is thrown because a level 0 ciphertext cannot be rescaled
+    ASSERT_THROW(ckks_instance.multiply_relin_rescale_inplace(ciphertext3, ciphertext3), invalid_argument);
+    ASSERT_THROW(ckks_instance.multiply_plain_rescale(ciphertext3, 2.0), invalid_argument);
+    // the input of the failed in-place operation is unchanged
+    ASSERT_LE(relative_error(vector3, ckks_instance.decrypt(ciphertext3)), MAX_NORM);
+}
+
+TEST(HomomorphicTest, MultiplyPlainRescale) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE);
+    CKKSCiphertext ciphertext1, ciphertext2, ciphertext3;
+    vector<double> vector1 = random_vector(NUM_OF_SLOTS, RANGE);
+    vector<double> vector2 = random_vector(NUM_OF_SLOTS, RANGE);
+    double plaintext = 3.0;
+    ciphertext1 = ckks_instance.encrypt(vector1);
+    vector<double> vector3(NUM_OF_SLOTS);
+    vector<double> vector4(NUM_OF_SLOTS);
+    transform(vector1.begin(), vector1.end(), vector2.begin(), vector3.begin(), multiplies<>());
+    transform(vector1.begin(), vector1.end(), vector4.begin(), [plaintext](double x) { return x * plaintext; });
+    ciphertext2 = ckks_instance.multiply_plain_rescale(ciphertext1, vector2);
+    ciphertext3 = ckks_instance.multiply_plain_rescale(ciphertext1, plaintext);
+    // Check scale and he_level.
+    uint64_t prime = ckks_instance.context->get_qi(ONE_MULTI_DEPTH);
+    ASSERT_EQ(ciphertext2.he_level(), ZERO_MULTI_DEPTH);
+    ASSERT_EQ(ciphertext2.scale(), pow(2, LOG_SCALE * 2) / prime);
+    ASSERT_EQ(ciphertext3.he_level(), ZERO_MULTI_DEPTH);
+    ASSERT_EQ(ciphertext3.scale(), pow(2, LOG_SCALE * 2) / prime);
+    // Check vector values.
+    double diff = relative_error(vector3, ckks_instance.decrypt(ciphertext2));
+    ASSERT_NE(diff, INVALID_NORM);
+    ASSERT_LE(diff, MAX_NORM);
+    diff = relative_error(vector4, ckks_instance.decrypt(ciphertext3));
+    ASSERT_NE(diff, INVALID_NORM);
+    ASSERT_LE(diff, MAX_NORM);
+}
+
+TEST(HomomorphicTest, InnerProduct) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE);
+    int length = 4;
+    vector<CKKSCiphertext> cts1, cts2;
+    vector<double> expected(NUM_OF_SLOTS, 0);
+    for (int i = 0; i < length; i++) {
+        vector<double> vector1 = random_vector(NUM_OF_SLOTS, RANGE);
+        vector<double> vector2 = random_vector(NUM_OF_SLOTS, RANGE);
+        cts1.push_back(ckks_instance.encrypt(vector1));
+        cts2.push_back(ckks_instance.encrypt(vector2));
+        for (int j = 0; j < NUM_OF_SLOTS; j++) {
+            expected[j] += vector1[j] * vector2[j];
+        }
+    }
+    CKKSCiphertext ciphertext = ckks_instance.inner_product(cts1, cts2);
+    // Check scale and he_level.
+    ASSERT_EQ(ciphertext.he_level(), ZERO_MULTI_DEPTH);
+    uint64_t prime = ckks_instance.context->get_qi(ONE_MULTI_DEPTH);
+    ASSERT_EQ(ciphertext.scale(), pow(2, LOG_SCALE * 2) / prime);
+    ASSERT_FALSE(ciphertext.needs_relin());
+    // Check vector values.
+    vector<double> actual = ckks_instance.decrypt(ciphertext);
+    double diff = relative_error(expected, actual);
+    ASSERT_NE(diff, INVALID_NORM);
+    ASSERT_LE(diff, MAX_NORM);
+}
+
+TEST(HomomorphicTest, InnerProduct_InvalidCase) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE);
+    vector<double> vector1 = random_vector(NUM_OF_SLOTS, RANGE);
+    CKKSCiphertext ciphertext = ckks_instance.encrypt(vector1);
+    // Expect invalid_argument is thrown because the inputs are empty.
+    ASSERT_THROW(ckks_instance.inner_product({}, {}), invalid_argument);
+    // Expect invalid_argument is thrown because the inputs have different lengths.
+    ASSERT_THROW(ckks_instance.inner_product({ciphertext, ciphertext}, {ciphertext}), invalid_argument);
+}
+
 TEST(HomomorphicTest, Constructor_ScaleBelowLowerBounds) {
     ASSERT_THROW((
                      // Expect invalid_argument is thrown because the scale is less than the minimum, 22.
@@ -402,6 +828,36 @@ TEST(HomomorphicTest, ReduceLevelTo) {
     ASSERT_LE(diff, MAX_NORM);
 }
 
+TEST(HomomorphicTest, ReduceLevelTo_MultipleLevels) {
+    const int max_level = 3;
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, max_level, LOG_SCALE);
+    vector<double> vector1 = random_vector(NUM_OF_SLOTS, RANGE);
+    CKKSCiphertext ciphertext1 = ckks_instance.encrypt(vector1);
+
+    CKKSCiphertext ciphertext2 = ckks_instance.reduce_level_to(ciphertext1, ZERO_MULTI_DEPTH);
+    ckks_instance.set_fast_level_reduction(false);
+    CKKSCiphertext ciphertext3 = ckks_instance.reduce_level_to(ciphertext1, ZERO_MULTI_DEPTH);
+
+    // Both strategies must agree with the scale of a fresh encryption at the target level
+    CKKSCiphertext ciphertext4 = ckks_instance.encrypt(vector1, ZERO_MULTI_DEPTH);
+    ASSERT_EQ(ciphertext2.he_level(), ZERO_MULTI_DEPTH);
+    ASSERT_EQ(ciphertext3.he_level(), ZERO_MULTI_DEPTH);
+    ASSERT_EQ(ciphertext2.scale(), ciphertext4.scale());
+    ASSERT_EQ(ciphertext3.scale(), ciphertext4.scale());
+    ASSERT_EQ(ciphertext2.backend_scale(), ciphertext4.backend_scale());
+    // Ciphertexts produced by the fast path can be combined with other ciphertexts at the same level
+    ckks_instance.add_inplace(ciphertext2, ciphertext4);
+    vector<double> expected_output(NUM_OF_SLOTS);
+    transform(vector1.begin(), vector1.end(), vector1.begin(), expected_output.begin(), plus<>());
+
+    double diff = relative_error(expected_output, ckks_instance.decrypt(ciphertext2));
+    ASSERT_NE(diff, INVALID_NORM);
+    ASSERT_LE(diff, MAX_NORM);
+    diff = relative_error(vector1, ckks_instance.decrypt(ciphertext3));
+    ASSERT_NE(diff, INVALID_NORM);
+    ASSERT_LE(diff, MAX_NORM);
+}
+
 TEST(HomomorphicTest, ReduceLevelTo_InvalidCase) {
     HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ZERO_MULTI_DEPTH, LOG_SCALE);
     CKKSCiphertext ciphertext1;
@@ -456,3 +912,146 @@ TEST(HomomorphicTest, RescaleToNextInPlace) {
     ASSERT_NE(diff, INVALID_NORM);
     ASSERT_LE(diff, MAX_NORM);
 }
+
+TEST(HomomorphicTest, ThreadLocalMemoryPools) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE);
+    ckks_instance.set_thread_local_memory_pools(true);
+    vector<double> vector1 = random_vector(NUM_OF_SLOTS, RANGE);
+    vector<double> vector2(NUM_OF_SLOTS);
+    transform(vector1.begin(), vector1.end(), vector1.begin(), vector2.begin(), multiplies<>());
+    CKKSCiphertext ciphertext1 = ckks_instance.encrypt(vector1);
+    CKKSCiphertext ciphertext2 = ckks_instance.multiply_relin_rescale(ciphertext1, ciphertext1);
+    // Check vector values.
+    double diff = relative_error(vector2, ckks_instance.decrypt(ciphertext2));
+    ASSERT_NE(diff, INVALID_NORM);
+    ASSERT_LE(diff, MAX_NORM);
+    // The global pool is listed first, followed by the pool for this thread.
+    vector<MemoryPoolStats> stats = ckks_instance.memory_pool_stats();
+    ASSERT_EQ(stats.size(), 2);
+    ASSERT_EQ(stats[0].thread_id, thread::id());
+    ASSERT_EQ(stats[1].thread_id, this_thread::get_id());
+    ASSERT_GT(stats[1].alloc_bytes, 0);
+}
+
+TEST(HomomorphicTest, ZeroEncryptionPool) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE);
+    ZeroEncryptionPoolConfig config;
+    config.levels = {ZERO_MULTI_DEPTH, ONE_MULTI_DEPTH};
+    config.depth = 4;
+    config.refill_threshold = 2;
+    ckks_instance.enable_zero_encryption_pool(config);
+    ckks_instance.fill_zero_encryption_pool();
+    ZeroEncryptionPoolStats stats = ckks_instance.zero_encryption_pool_stats();
+    ASSERT_EQ(stats.available[ZERO_MULTI_DEPTH], config.depth);
+    ASSERT_EQ(stats.available[ONE_MULTI_DEPTH], config.depth);
+
+    vector<double> vector1 = random_vector(NUM_OF_SLOTS, RANGE);
+    CKKSCiphertext ciphertext1 = ckks_instance.encrypt(vector1);
+    CKKSCiphertext ciphertext2 = ckks_instance.encrypt(vector1, ZERO_MULTI_DEPTH);
+    stats = ckks_instance.zero_encryption_pool_stats();
+    ASSERT_EQ(stats.hits, 2);
+    ASSERT_EQ(stats.misses, 0);
+    ASSERT_GE(stats.generated, 2 * config.depth);
+    // Encryptions from the pool have the same metadata as inline encryptions
+    ckks_instance.disable_zero_encryption_pool();
+    CKKSCiphertext ciphertext3 = ckks_instance.encrypt(vector1, ZERO_MULTI_DEPTH);
+    ASSERT_EQ(ciphertext1.he_level(), ONE_MULTI_DEPTH);
+    ASSERT_EQ(ciphertext2.he_level(), ZERO_MULTI_DEPTH);
+    ASSERT_EQ(ciphertext2.scale(), ciphertext3.scale());
+    // Check vector values.
+    for (const auto &ct : {ciphertext1, ciphertext2}) {
+        double diff = relative_error(vector1, ckks_instance.decrypt(ct, true));
+        ASSERT_NE(diff, INVALID_NORM);
+        ASSERT_LE(diff, MAX_NORM);
+    }
+}
+
+TEST(HomomorphicTest, ZeroEncryptionPool_Stats) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE);
+    ZeroEncryptionPoolConfig config;
+    config.depth = 2;
+    config.refill_threshold = 1;
+    ckks_instance.enable_zero_encryption_pool(config);
+    ckks_instance.fill_zero_encryption_pool();
+    vector<double> vector1 = random_vector(NUM_OF_SLOTS, RANGE);
+    // the default configuration only pools the maximum level
+    ckks_instance.encrypt(vector1);
+    ckks_instance.encrypt(vector1, ZERO_MULTI_DEPTH);
+    ZeroEncryptionPoolStats stats = ckks_instance.zero_encryption_pool_stats();
+    ASSERT_EQ(stats.hits, 1);
+    ASSERT_EQ(stats.misses, 1);
+    ASSERT_EQ(stats.available.size(), 1);
+    ASSERT_EQ(stats.available.count(ONE_MULTI_DEPTH), 1);
+}
+
+TEST(HomomorphicTest, ZeroEncryptionPool_GeneratorError) {
+    ZeroEncryptionPoolConfig config;
+    config.levels = {0, 1};
+    config.depth = 2;
+    config.refill_threshold = 1;
+    // generating encryptions of zero fails at level 0
+    ZeroEncryptionPool pool(config, 1, [](int level, seal::Ciphertext &) {
+        if (level == 0) {
+            throw runtime_error("Unable to generate an encryption of zero");
+        }
+    });
+    // Expect runtime_error is rethrown because level 0 cannot be filled
+    ASSERT_THROW(pool.fill(), runtime_error);
+
+    // the failed level falls back to inline encryption, and the other level is unaffected
+    seal::Ciphertext ct;
+    ASSERT_FALSE(pool.take(0, ct));
+    ASSERT_TRUE(pool.take(1, ct));
+    ZeroEncryptionPoolStats stats = pool.stats();
+    ASSERT_EQ(stats.misses, 1);
+    ASSERT_EQ(stats.hits, 1);
+    ASSERT_EQ(stats.available[0], 0);
+}
+
+TEST(HomomorphicTest, ZeroEncryptionPool_InvalidCase) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE);
+    ZeroEncryptionPoolConfig config;
+    config.levels = {ONE_MULTI_DEPTH + 1};
+    // Expect invalid_argument is thrown because the level is too high.
+    ASSERT_THROW(ckks_instance.enable_zero_encryption_pool(config), invalid_argument);
+    config.levels = {};
+    config.refill_threshold = config.depth + 1;
+    // Expect invalid_argument is thrown because the refill threshold is larger than the depth.
+    ASSERT_THROW(ckks_instance.enable_zero_encryption_pool(config), invalid_argument);
+}
+
+TEST(HomomorphicTest, PlaintextCache) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE);
+    vector<double> vector1 = random_vector(NUM_OF_SLOTS, RANGE);
+    vector<double> vector2 = random_vector(NUM_OF_SLOTS, RANGE);
+    vector<double> expected_output(NUM_OF_SLOTS);
+    transform(vector1.begin(), vector1.end(), vector2.begin(), expected_output.begin(), multiplies<>());
+    CKKSCiphertext ciphertext1 = ckks_instance.encrypt(vector1);
+
+    CKKSCiphertext ciphertext2 = ckks_instance.multiply_plain(ciphertext1, vector2);
+    CKKSCiphertext ciphertext3 = ckks_instance.multiply_plain(ciphertext1, vector2);
+    PlaintextCacheStats stats = ckks_instance.plaintext_cache_stats();
+    ASSERT_EQ(stats.misses, 1);
+    ASSERT_EQ(stats.hits, 1);
+    ASSERT_EQ(stats.entries, 1);
+    ASSERT_GT(stats.size_bytes, 0);
+
+    // a different level is a different encoding
+    CKKSCiphertext ciphertext4 = ckks_instance.reduce_level_to(ciphertext1, ZERO_MULTI_DEPTH);
+    ckks_instance.add_plain_inplace(ciphertext4, vector2);
+    ASSERT_EQ(ckks_instance.plaintext_cache_stats().misses, 2);
+
+    ckks_instance.rescale_to_next_inplace(ciphertext3);
+    vector<double> vector3 = ckks_instance.decrypt(ciphertext3);
+    double diff = relative_error(expected_output, vector3);
+    ASSERT_NE(diff, INVALID_NORM);
+    ASSERT_LE(diff, MAX_NORM);
+
+    // shrinking the limit evicts entries; a limit of zero disables the cache
+    ckks_instance.set_plaintext_cache_limit(0);
+    stats = ckks_instance.plaintext_cache_stats();
+    ASSERT_EQ(stats.entries, 0);
+    ASSERT_EQ(stats.size_bytes, 0);
+    ckks_instance.multiply_plain(ciphertext1, vector2);
+    ASSERT_EQ(ckks_instance.plaintext_cache_stats().misses, 2);
+}
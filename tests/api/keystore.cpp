@@ -0,0 +1,122 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "hit/api/keystore.h"
+
+#include <cstdint>
+#include <thread>
+
+#include "../testutil.h"
+#include "gtest/gtest.h"
+#include "hit/api/evaluator/homomorphic.h"
+#include "hit/common.h"
+
+using namespace std;
+using namespace hit;
+
+// Test variables.
+const int RANGE = 16;
+const int NUM_OF_SLOTS = 4096;
+const int ONE_MULTI_DEPTH = 1;
+const int LOG_SCALE = 30;
+const int STEPS = 1;
+
+namespace {
+    void add_tenant(KeyStore &store, const string &tenant, HomomorphicEval &instance) {
+        stringstream paramsStream(ios::in | ios::out | ios::binary);
+        stringstream galoisKeyStream(ios::in | ios::out | ios::binary);
+        stringstream relinKeyStream(ios::in | ios::out | ios::binary);
+        instance.save(paramsStream, galoisKeyStream, relinKeyStream, nullptr);
+        store.add_tenant(tenant, paramsStream, galoisKeyStream, relinKeyStream);
+    }
+
+    // rotate and square (with relinearization) a ciphertext from `client` with `server`, and check the result
+    void check_evaluator(HomomorphicEval &client, HomomorphicEval &server) {
+        vector<double> vector1 = random_vector(NUM_OF_SLOTS, RANGE);
+        CKKSCiphertext rotated_ct = server.rotate_left(client.encrypt(vector1), STEPS);
+        CKKSCiphertext ciphertext = server.multiply_relin_rescale(rotated_ct, rotated_ct);
+        vector<double> expected(NUM_OF_SLOTS);
+        for (int i = 0; i < NUM_OF_SLOTS; i++) {
+            double rotated = vector1[(i + STEPS) % NUM_OF_SLOTS];
+            expected[i] = rotated * rotated;
+        }
+        ASSERT_LE(relative_error(expected, client.decrypt(ciphertext)), MAX_NORM);
+    }
+}  // namespace
+
+TEST(KeyStoreTest, Evaluator) {
+    HomomorphicEval client = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE, vector<int>{STEPS});
+    TempDir spill_dir;
+    KeyStore store(spill_dir.path(), SIZE_MAX);
+    add_tenant(store, "tenant", client);
+    ASSERT_TRUE(store.has_tenant("tenant"));
+    ASSERT_EQ(store.num_resident_tenants(), 0);
+
+    shared_ptr<HomomorphicEval> server = store.evaluator("tenant");
+    ASSERT_EQ(store.num_resident_tenants(), 1);
+    ASSERT_EQ(store.evaluator("tenant"), server);
+    check_evaluator(client, *server);
+
+    // Expect invalid_argument is thrown because the tenant already exists
+    ASSERT_THROW(add_tenant(store, "tenant", client), invalid_argument);
+    store.remove_tenant("tenant");
+    ASSERT_FALSE(store.has_tenant("tenant"));
+    ASSERT_EQ(store.resident_bytes(), 0);
+    // Expect invalid_argument is thrown because the tenant does not exist
+    ASSERT_THROW(store.evaluator("tenant"), invalid_argument);
+}
+
+TEST(KeyStoreTest, MemoryBudget) {
+    HomomorphicEval client1 = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE, vector<int>{STEPS});
+    HomomorphicEval client2 = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE, vector<int>{STEPS});
+
+    TempDir spill_dir;
+    size_t tenant_size;
+    {
+        KeyStore store(spill_dir.path(), SIZE_MAX);
+        add_tenant(store, "tenant1", client1);
+        store.evaluator("tenant1");
+        tenant_size = store.resident_bytes();
+    }
+
+    // the budget only fits one tenant
+    KeyStore store(spill_dir.path(), tenant_size * 3 / 2);
+    add_tenant(store, "tenant1", client1);
+    add_tenant(store, "tenant2", client2);
+
+    store.evaluator("tenant1");
+    ASSERT_EQ(store.num_resident_tenants(), 1);
+    shared_ptr<HomomorphicEval> server2 = store.evaluator("tenant2");
+    ASSERT_EQ(store.num_resident_tenants(), 1);
+    ASSERT_EQ(server2->context, client2.context);
+    check_evaluator(client2, *server2);
+
+    // tenant2 is in use, so it cannot be evicted
+    shared_ptr<HomomorphicEval> server1 = store.evaluator("tenant1");
+    ASSERT_EQ(store.num_resident_tenants(), 2);
+    ASSERT_GT(store.resident_bytes(), tenant_size * 3 / 2);
+    check_evaluator(client1, *server1);
+}
+
+TEST(KeyStoreTest, ConcurrentLoad) {
+    HomomorphicEval client = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE, vector<int>{STEPS});
+    TempDir spill_dir;
+    KeyStore store(spill_dir.path(), SIZE_MAX);
+    add_tenant(store, "tenant", client);
+
+    // the tenant is only loaded once, and every thread receives the same evaluator
+    const int num_threads = 4;
+    vector<shared_ptr<HomomorphicEval>> servers(num_threads);
+    vector<thread> threads;
+    for (int i = 0; i < num_threads; i++) {
+        threads.emplace_back([&store, &servers, i]() { servers[i] = store.evaluator("tenant"); });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    for (const auto &server : servers) {
+        ASSERT_EQ(server, servers[0]);
+    }
+    ASSERT_EQ(store.num_resident_tenants(), 1);
+    check_evaluator(client, *servers[0]);
+}
@@ -2678,3 +2678,60 @@ TEST(LinearAlgebraTest, RescaleToNext_RowVec) {
     ASSERT_FALSE(ct_vec1.needs_relin());
     ASSERT_FALSE(ct_vec1.needs_rescale());
 }
+
+void test_async(LinearAlgebra &linear_algebra, bool test) {
+    // a 64x128 encoding unit
+    int unit1_height = 64;
+    EncodingUnit unit1 = linear_algebra.make_unit(unit1_height);
+    int unit1_width = 8192 / unit1_height;
+
+    // each matrix spans more than one encoding unit, so that the results have several units
+    Matrix matrix_a_transpose = random_mat(unit1_height, unit1_width + 72);
+    Matrix matrix_b = random_mat(unit1_height, unit1_width + 22);
+    Matrix matrix_c = random_mat(unit1_height + 36, unit1_width);
+    Matrix matrix_d_transpose = random_mat(50, unit1_width + 22);
+    AsyncEncrypted<EncryptedMatrix> ct_a_transpose(linear_algebra.encrypt_matrix(matrix_a_transpose, unit1));
+    int top_level = ct_a_transpose.get().he_level();
+    AsyncEncrypted<EncryptedMatrix> ct_b(linear_algebra.encrypt_matrix(matrix_b, unit1, top_level - 1));
+    AsyncEncrypted<EncryptedMatrix> ct_c(linear_algebra.encrypt_matrix(matrix_c, unit1));
+    AsyncEncrypted<EncryptedMatrix> ct_d_transpose(linear_algebra.encrypt_matrix(matrix_d_transpose, unit1));
+
+    // independent branches; each unit of a result is computed as soon as the units it depends on are ready
+    AsyncEncrypted<EncryptedMatrix> ct_product = linear_algebra.rescale_to_next_async(
+        linear_algebra.multiply_row_major_async(ct_a_transpose, ct_b, PI));
+    AsyncEncrypted<EncryptedMatrix> ct_col_product = linear_algebra.multiply_col_major_async(ct_b, ct_d_transpose);
+    AsyncEncrypted<EncryptedMatrix> ct_c_sum = linear_algebra.add_async(ct_c, ct_c);
+    AsyncEncrypted<EncryptedRowVector> ct_sum_cols = linear_algebra.sum_cols_async(ct_c_sum);
+    AsyncEncrypted<EncryptedColVector> ct_sum_rows = linear_algebra.sum_rows_async(ct_c_sum);
+
+    // Expect invalid_argument is thrown because the inputs have different dimensions
+    ASSERT_THROW(linear_algebra.add_async(ct_product, ct_c), invalid_argument);
+    // Expect invalid_argument is thrown because the units of the inputs are at different levels
+    AsyncEncrypted<EncryptedMatrix> ct_b_top(linear_algebra.encrypt_matrix(matrix_b, unit1));
+    ASSERT_THROW(linear_algebra.add_async(ct_b, ct_b_top).get(), invalid_argument);
+
+    if (test) {
+        Matrix expected_product = PI * prec_prod(trans(matrix_a_transpose), matrix_b);
+        ASSERT_LT(relative_error(linear_algebra.decrypt(ct_product.get()), expected_product), MAX_NORM);
+        ASSERT_EQ(ct_product.get().he_level(), 0);
+        Matrix expected_col_product = prec_prod(matrix_b, trans(matrix_d_transpose));
+        ASSERT_LT(relative_error(linear_algebra.decrypt(ct_col_product.get()), expected_col_product), MAX_NORM);
+        ASSERT_TRUE(ct_col_product.get().needs_rescale());
+        Vector expected_sum_cols = 2.0 * sum_cols_plaintext(matrix_c);
+        ASSERT_LT(relative_error(linear_algebra.decrypt(ct_sum_cols.get()), expected_sum_cols), MAX_NORM);
+        Vector expected_sum_rows = 2.0 * sum_rows_plaintext(matrix_c);
+        ASSERT_LT(relative_error(linear_algebra.decrypt(ct_sum_rows.get()), expected_sum_rows), MAX_NORM);
+    }
+    linear_algebra.wait();
+}
+
+TEST(LinearAlgebraTest, Async) {
+    RotationSet rot_instance = RotationSet(8192);
+    LinearAlgebra linear_algebra_rot = LinearAlgebra(rot_instance);
+    test_async(linear_algebra_rot, false);
+    vector<int> rotations = rot_instance.needed_rotations();
+
+    HomomorphicEval ckks_instance = HomomorphicEval(8192, THREE_MULTI_DEPTH, LOG_SCALE, rotations);
+    LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance, 2);
+    test_async(linear_algebra, true);
+}
@@ -0,0 +1,95 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "hit/api/rotationplan.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "../testutil.h"
+#include "gtest/gtest.h"
+#include "hit/api/context.h"
+#include "hit/api/evaluator/homomorphic.h"
+#include "hit/api/evaluator/rotations.h"
+#include "hit/common.h"
+
+using namespace std;
+using namespace hit;
+
+// Test variables.
+const int RANGE = 16;
+const int NUM_OF_SLOTS = 4096;
+const int ONE_MULTI_DEPTH = 1;
+const int LOG_SCALE = 30;
+
+namespace {
+    uint64_t key_size() {
+        return estimate_key_size(1, NUM_OF_SLOTS, ONE_MULTI_DEPTH) - estimate_key_size(0, NUM_OF_SLOTS, ONE_MULTI_DEPTH);
+    }
+}  // namespace
+
+TEST(RotationPlanTest, AllKeysFit) {
+    vector<RotationCount> rotations{{1, 1, 2}, {-3, 0, 1}, {NUM_OF_SLOTS, 0, 1}};
+    RotationKeyPlan plan = plan_rotation_keys(rotations, NUM_OF_SLOTS, ONE_MULTI_DEPTH, 2 * key_size());
+    ASSERT_EQ(plan.key_steps, (vector<int>{-3, 1}));
+    ASSERT_TRUE(plan.decompositions.empty());
+    ASSERT_EQ(plan.rotation_cost, 2 * 6 + 2);
+    ASSERT_EQ(plan.extra_rotations, 0);
+    ASSERT_EQ(plan.extra_rotation_cost, 0);
+}
+
+TEST(RotationPlanTest, Budget) {
+    vector<RotationCount> rotations{{1, 0, 10}, {2, 0, 10}, {3, 0, 1}, {-5, 1, 1}};
+    RotationKeyPlan plan = plan_rotation_keys(rotations, NUM_OF_SLOTS, ONE_MULTI_DEPTH, 3 * key_size());
+    ASSERT_EQ(plan.key_steps.size(), 3);
+
+    uint64_t extra_rotations = 0;
+    for (const auto &rotation : rotations) {
+        auto decomposition = plan.decompositions.find(rotation.step);
+        if (decomposition == plan.decompositions.end()) {
+            ASSERT_NE(find(plan.key_steps.begin(), plan.key_steps.end(), rotation.step), plan.key_steps.end());
+            continue;
+        }
+        for (int key_step : decomposition->second) {
+            ASSERT_NE(find(plan.key_steps.begin(), plan.key_steps.end(), key_step), plan.key_steps.end());
+        }
+        int total = accumulate(decomposition->second.begin(), decomposition->second.end(), 0);
+        ASSERT_EQ((total - rotation.step) % NUM_OF_SLOTS, 0);
+        extra_rotations += rotation.count * (decomposition->second.size() - 1);
+    }
+    ASSERT_EQ(plan.extra_rotations, extra_rotations);
+    // the rare step is composed from two keys
+    ASSERT_EQ(plan.key_steps, (vector<int>{-5, 1, 2}));
+    ASSERT_EQ(plan.extra_rotations, 1);
+    ASSERT_EQ(plan.extra_rotation_cost, 2);
+
+    // Expect invalid_argument is thrown because the budget does not allow a single key
+    ASSERT_THROW(plan_rotation_keys(rotations, NUM_OF_SLOTS, ONE_MULTI_DEPTH, key_size() - 1), invalid_argument);
+}
+
+TEST(RotationPlanTest, HomomorphicEval) {
+    vector<int> steps{1, 2, 3, 7};
+    RotationSet rotation_set(NUM_OF_SLOTS);
+    CKKSCiphertext ct = rotation_set.encrypt(vector<double>(NUM_OF_SLOTS));
+    rotation_set.rotate_many(ct, steps);
+    rotation_set.rotate_right(ct, 1);
+
+    RotationKeyPlan plan =
+        plan_rotation_keys(rotation_set.rotation_counts(), NUM_OF_SLOTS, ONE_MULTI_DEPTH, 2 * key_size());
+    ASSERT_FALSE(plan.decompositions.empty());
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE, plan.key_steps);
+    ckks_instance.set_rotation_plan(plan);
+
+    vector<double> vector1 = random_vector(NUM_OF_SLOTS, RANGE);
+    CKKSCiphertext ciphertext = ckks_instance.encrypt(vector1);
+    vector<CKKSCiphertext> rotated = ckks_instance.rotate_many(ciphertext, steps);
+    rotated.push_back(ckks_instance.rotate_right(ciphertext, 1));
+    steps.push_back(-1);
+    for (int i = 0; i < steps.size(); i++) {
+        vector<double> expected(NUM_OF_SLOTS);
+        for (int j = 0; j < NUM_OF_SLOTS; j++) {
+            expected[j] = vector1[(j + steps[i] + NUM_OF_SLOTS) % NUM_OF_SLOTS];
+        }
+        ASSERT_LE(relative_error(expected, ckks_instance.decrypt(rotated[i], true)), MAX_NORM);
+    }
+}
@@ -0,0 +1,104 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "hit/scheduler.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "hit/common.h"
+
+using namespace std;
+using namespace hit;
+
+const int NUM_ITERATIONS = 1000;
+
+TEST(TaskSchedulerTest, ParallelForEach) {
+    TaskScheduler scheduler;
+    vector<atomic<int>> visits(NUM_ITERATIONS);
+    scheduler.parallel_for_each(NUM_ITERATIONS, [&](int i) { visits[i]++; }, 16);
+    for (const auto &count : visits) {
+        ASSERT_EQ(count.load(), 1);
+    }
+    // empty loops are allowed
+    scheduler.parallel_for_each(0, [&](int) { FAIL(); });
+}
+
+TEST(TaskSchedulerTest, Nested) {
+    TaskScheduler scheduler(2);
+    atomic<int> count(0);
+    scheduler.parallel_for_each(10, [&](int) {
+        scheduler.parallel_for_each(10, [&](int) { count++; });
+        // loops which use the macro run in the same arena
+        parallel_for(10, [&](int) { count++; });
+    });
+    ASSERT_EQ(count.load(), 200);
+}
+
+TEST(TaskSchedulerTest, MaxConcurrency) {
+    TaskScheduler scheduler(2);
+    ASSERT_LE(scheduler.max_concurrency(), 2);
+    atomic<int> active(0);
+    atomic<int> max_active(0);
+    scheduler.parallel_for_each(20, [&](int) {
+        int now_active = ++active;
+        int observed = max_active;
+        while (now_active > observed && !max_active.compare_exchange_weak(observed, now_active)) {
+        }
+        this_thread::sleep_for(chrono::milliseconds(1));
+        active--;
+    });
+    ASSERT_LE(max_active.load(), 2);
+}
+
+TEST(TaskSchedulerTest, Exceptions) {
+    TaskScheduler scheduler;
+    ASSERT_THROW(scheduler.parallel_for_each(NUM_ITERATIONS,
+                                             [&](int i) {
+                                                 if (i == NUM_ITERATIONS / 2) {
+                                                     throw runtime_error("error in loop body");
+                                                 }
+                                             }),
+                 runtime_error);
+    // Expect invalid_argument is thrown because the grain size is not positive
+    ASSERT_THROW(scheduler.parallel_for_each(NUM_ITERATIONS, [&](int) {}, 0), invalid_argument);
+    // Expect invalid_argument is thrown because the concurrency limit is negative
+    ASSERT_THROW(TaskScheduler(-1), invalid_argument);
+}
+
+TEST(TaskSchedulerTest, Submit) {
+    TaskScheduler scheduler(2);
+    Future<int> one = make_ready_future(1);
+    // a chain of dependent operations, each of which is launched by the one before it
+    Future<int> sum = one;
+    for (int i = 0; i < NUM_ITERATIONS; i++) {
+        sum = scheduler.submit<int>([](int a, int b) { return a + b; }, sum, one);
+    }
+    ASSERT_EQ(sum.get(), NUM_ITERATIONS + 1);
+
+    vector<Future<int>> inputs;
+    for (int i = 0; i < 10; i++) {
+        inputs.push_back(scheduler.submit<int>([i]() { return i; }));
+    }
+    Future<int> total = scheduler.submit_all<int>(
+        [](const vector<const int *> &values) {
+            int result = 0;
+            for (const int *value : values) {
+                result += *value;
+            }
+            return result;
+        },
+        inputs);
+    ASSERT_EQ(total.get(), 45);
+
+    // exceptions propagate to dependent operations
+    Future<int> failed = scheduler.submit<int>([]() -> int { throw runtime_error("error in operation"); });
+    Future<int> dependent = scheduler.submit<int>([](int a) { return a; }, failed);
+    ASSERT_THROW(dependent.get(), runtime_error);
+    scheduler.wait();
+    ASSERT_TRUE(dependent.is_ready());
+}
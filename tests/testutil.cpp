@@ -5,6 +5,10 @@
 
 #include <glog/logging.h>
 
+#include <cstdlib>
+#include <filesystem>
+#include <stdexcept>
+
 #include "gtest/gtest.h"
 
 using namespace std;
@@ -38,6 +42,23 @@ Matrix random_mat(int height, int width) {
     return Matrix(height, width, random_vector(height * width, max_vec_norm));
 }
 
+TempDir::TempDir() {
+    string path_template = (filesystem::temp_directory_path() / "hit_test_XXXXXX").string();
+    if (mkdtemp(path_template.data()) == nullptr) {
+        throw runtime_error("Unable to create a temporary directory in " + filesystem::temp_directory_path().string());
+    }
+    path_ = path_template;
+}
+
+TempDir::~TempDir() {
+    error_code error;
+    filesystem::remove_all(path_, error);
+}
+
+const string &TempDir::path() const {
+    return path_;
+}
+
 int main(int argc, char **argv) {
     srand(time(NULL));
     ::testing::InitGoogleTest(&argc, argv);
@@ -4,6 +4,7 @@
 #pragma once
 
 #include <iostream>
+#include <string>
 #include <vector>
 
 #include "hit/common.h"
@@ -15,3 +16,18 @@ std::vector<double> random_vector(int dim, double max_norm);
 hit::Vector random_vec(int size);
 
 hit::Matrix random_mat(int height, int width);
+
+// A new directory in the system's temporary directory, which is removed along with its contents when this is destroyed
+class TempDir {
+   public:
+    TempDir();
+    ~TempDir();
+
+    TempDir(const TempDir &) = delete;
+    TempDir &operator=(const TempDir &) = delete;
+
+    const std::string &path() const;
+
+   private:
+    std::string path_;
+};